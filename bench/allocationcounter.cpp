@@ -0,0 +1,27 @@
+#include <cstdlib>
+#include <new>
+
+#include "../src/stats.hpp"
+
+// Replacement of the global allocator counting the allocations of the bench, see
+// countAllocation(). The other targets keep the default one.
+
+void *operator new(std::size_t size)
+{
+    countAllocation();
+    if (void *p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
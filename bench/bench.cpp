@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <set>
+#include <string>
+
+#include "rapidcsv.h"
+#include "sheetgenerator.hpp"
+#include "../src/convert.hpp"
+#include "../src/filereader.hpp"
+#include "../src/stats.hpp"
+
+struct StageResult
+{
+    double bestMs = 0;
+    double meanMs = 0;
+    size_t allocations = 0;
+};
+
+/**
+ * Run a stage the given number of times, keeping the best and mean wall time and the
+ * allocation count of the last run.
+ */
+static StageResult runStage(int iterations, const std::function<void()> &stage)
+{
+    StageResult result;
+    double totalMs = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        const size_t allocationsBefore = allocationCount();
+        const auto start = std::chrono::steady_clock::now();
+        stage();
+        const auto end = std::chrono::steady_clock::now();
+        result.allocations = allocationCount() - allocationsBefore;
+
+        const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        result.bestMs = i == 0 ? ms : std::min(result.bestMs, ms);
+        totalMs += ms;
+    }
+    result.meanMs = totalMs / iterations;
+    return result;
+}
+
+static void printStage(const char *name, const StageResult &result, size_t bytes, size_t keys)
+{
+    const double seconds = result.bestMs / 1000;
+    std::printf("%-12s %10.2f %10.2f %10.1f %12.0f %12zu\n",
+                name,
+                result.bestMs,
+                result.meanMs,
+                bytes / seconds / (1024 * 1024),
+                keys / seconds,
+                result.allocations);
+}
+
+static void printUsage()
+{
+    std::printf("Usage: bench [options]\n"
+                "  --rows N                 keys in the sheet (default 100000)\n"
+                "  --languages N            language columns (default 2)\n"
+                "  --cell-length N          median cell length in characters (default 24)\n"
+                "  --cell-length-sigma X    sigma of the log-normal cell length (default 0.8)\n"
+                "  --multiline X            share of multi-line cells (default 0.1)\n"
+                "  --cjk X                  share of CJK cells (default 0.3)\n"
+                "  --seed N                 random seed (default 1)\n"
+                "  --iterations N           runs per stage (default 5)\n");
+}
+
+int main(int argc, char **argv)
+{
+    SheetSpec spec;
+    int iterations = 5;
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        if (std::strcmp(arg, "--help") == 0)
+        {
+            printUsage();
+            return 0;
+        }
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr || std::strncmp(arg, "--", 2) != 0)
+        {
+            printUsage();
+            return 1;
+        }
+        i++;
+
+        if (std::strcmp(arg, "--rows") == 0)
+        {
+            spec.rowCount = std::strtoul(value, nullptr, 10);
+        }
+        else if (std::strcmp(arg, "--languages") == 0)
+        {
+            spec.langCount = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+        }
+        else if (std::strcmp(arg, "--cell-length") == 0)
+        {
+            spec.medianCellLength = std::strtod(value, nullptr);
+        }
+        else if (std::strcmp(arg, "--cell-length-sigma") == 0)
+        {
+            spec.cellLengthSigma = std::strtod(value, nullptr);
+        }
+        else if (std::strcmp(arg, "--multiline") == 0)
+        {
+            spec.multilineRatio = std::strtod(value, nullptr);
+        }
+        else if (std::strcmp(arg, "--cjk") == 0)
+        {
+            spec.cjkRatio = std::strtod(value, nullptr);
+        }
+        else if (std::strcmp(arg, "--seed") == 0)
+        {
+            spec.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        }
+        else if (std::strcmp(arg, "--iterations") == 0)
+        {
+            iterations = std::max(1, std::atoi(value));
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    const std::filesystem::path workFolder = std::filesystem::temp_directory_path() / "qpp-lang-converter-bench";
+    std::filesystem::remove_all(workFolder);
+    std::filesystem::create_directories(workFolder);
+    const std::string sheetFilename = (workFolder / "sheet.csv").string();
+    const size_t sheetBytes = generateSheet(spec, sheetFilename);
+    const std::vector<std::string> langNames = sheetLangNames(spec.langCount);
+    // One key per row, whatever the number of languages.
+    const size_t keyCount = spec.rowCount;
+
+    std::printf("sheet: %zu rows x %zu languages, %.2f MB\n\n", spec.rowCount, spec.langCount, sheetBytes / (1024.0 * 1024.0));
+    std::printf("%-12s %10s %10s %10s %12s %12s\n", "stage", "best ms", "mean ms", "MB/s", "keys/s", "allocations");
+
+    const StageResult readResult = runStage(iterations, [&]()
+    {
+        rapidcsv::Document doc = readCvs(sheetFilename);
+    });
+    printStage("readCvs", readResult, sheetBytes, keyCount);
+
+    {
+        const rapidcsv::Document doc = readCvs(sheetFilename);
+        size_t outputBytes = 0;
+        const StageResult writeResult = runStage(iterations, [&]()
+        {
+            outputBytes = 0;
+            for (auto &&langName : langNames)
+            {
+                const std::string filename = (workFolder / (langName + ".json")).string();
+                writeJson(doc, langName, filename);
+                outputBytes += std::filesystem::file_size(filename);
+            }
+        });
+        printStage("writeJson", writeResult, outputBytes, keyCount);
+    }
+
+    ConvertOptions options;
+    options.translationFilename = sheetFilename;
+    options.outputBaseFolder = (workFolder / "locales").string();
+    options.langNames = langNames;
+    options.serial = "bench";
+    options.reportFilename = (workFolder / "conversion-report.json").string();
+    const StageResult convertResult = runStage(iterations, [&]()
+    {
+        convertTranslations(options);
+    });
+    printStage("end-to-end", convertResult, sheetBytes, keyCount);
+
+    std::printf("\npeak RSS: %.1f MB\n", peakMemoryBytes() / (1024.0 * 1024.0));
+
+    std::filesystem::remove_all(workFolder);
+    return 0;
+}
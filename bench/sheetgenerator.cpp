@@ -0,0 +1,93 @@
+#include "sheetgenerator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+
+std::vector<std::string> sheetLangNames(size_t langCount)
+{
+    static const char *const knownNames[] = {"en", "zh", "ja", "ko", "fr", "de", "es", "it", "pt", "ru", "ar", "th", "vi", "id", "tr", "pl"};
+    const size_t knownCount = sizeof(knownNames) / sizeof(knownNames[0]);
+    std::vector<std::string> langNames;
+    for (size_t i = 0; i < langCount; i++)
+    {
+        langNames.push_back(i < knownCount ? knownNames[i] : "lang" + std::to_string(i));
+    }
+    return langNames;
+}
+
+size_t generateSheet(const SheetSpec &spec, const std::string &filename)
+{
+    static const char *const words[] = {"the", "account", "device", "settings", "please", "select", "confirm", "error", "network", "update", "password", "user", "connection", "failed", "saved", "loading"};
+    static const char *const cjkChars[] = {"\xe4\xb8\xad", "\xe6\x96\x87", "\xe8\xae\xbe", "\xe5\xa4\x87", "\xe7\xbd\x91", "\xe7\xbb\x9c", "\xe7\x94\xa8", "\xe6\x88\xb7", "\xe5\xaf\x86", "\xe7\xa0\x81", "\xe6\x9b\xb4", "\xe6\x96\xb0"};
+
+    std::mt19937 random(spec.seed);
+    std::lognormal_distribution<double> cellLength(std::log(std::max(spec.medianCellLength, 1.0)), spec.cellLengthSigma);
+    std::uniform_real_distribution<double> ratio(0.0, 1.0);
+    std::uniform_int_distribution<size_t> wordIndex(0, sizeof(words) / sizeof(words[0]) - 1);
+    std::uniform_int_distribution<size_t> cjkIndex(0, sizeof(cjkChars) / sizeof(cjkChars[0]) - 1);
+
+    std::ofstream output(filename, std::ios::binary);
+    output << "Translations";
+    for (size_t i = 0; i < spec.langCount + 1; i++)
+    {
+        output << ",";
+    }
+    output << "\n";
+
+    output << "Category,Key";
+    for (auto &&langName : sheetLangNames(spec.langCount))
+    {
+        output << "," << langName;
+    }
+    output << "\n";
+
+    std::string cell;
+    for (size_t row = 0; row < spec.rowCount; row++)
+    {
+        output << "common,page" << row % 97 << ".key" << row;
+        for (size_t lang = 0; lang < spec.langCount; lang++)
+        {
+            const size_t length = std::max<size_t>(1, static_cast<size_t>(cellLength(random)));
+            const bool isCjk = ratio(random) < spec.cjkRatio;
+            const bool isMultiline = ratio(random) < spec.multilineRatio;
+            cell.clear();
+            for (size_t count = 0; count < length;)
+            {
+                if (isCjk)
+                {
+                    cell += cjkChars[cjkIndex(random)];
+                    count++;
+                }
+                else
+                {
+                    if (cell.size() > 0)
+                    {
+                        cell += ' ';
+                    }
+                    const char *word = words[wordIndex(random)];
+                    cell += word;
+                    count += std::char_traits<char>::length(word) + 1;
+                }
+                if (isMultiline && count < length && ratio(random) < 0.1)
+                {
+                    cell += '\n';
+                }
+            }
+
+            output << ",";
+            if (isMultiline || cell.find(',') != std::string::npos)
+            {
+                output << "\"" << cell << "\n\"\"quoted\"\"\"";
+            }
+            else
+            {
+                output << cell;
+            }
+        }
+        output << "\n";
+    }
+
+    output.flush();
+    return static_cast<size_t>(output.tellp());
+}
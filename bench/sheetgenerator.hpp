@@ -0,0 +1,38 @@
+#ifndef SHEET_GENERATOR_HPP
+#define SHEET_GENERATOR_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Shape of a synthetic translation sheet.
+ */
+struct SheetSpec
+{
+    size_t rowCount = 100000;
+    size_t langCount = 2;
+    // Cell lengths in characters follow a log-normal distribution with this median and sigma.
+    double medianCellLength = 24;
+    double cellLengthSigma = 0.8;
+    // Share of cells holding quoted multi-line text.
+    double multilineRatio = 0.1;
+    // Share of cells made of CJK characters.
+    double cjkRatio = 0.3;
+    uint32_t seed = 1;
+};
+
+/**
+ * Language column names of a sheet with langCount languages.
+ */
+std::vector<std::string> sheetLangNames(size_t langCount);
+
+/**
+ * Write a sheet laid out like the translation file: a title row, the column names row, then one
+ * row per key with a category column, the key column and one column per language.
+ *
+ * @return Size of the file in bytes.
+ */
+size_t generateSheet(const SheetSpec &spec, const std::string &filename);
+
+#endif // SHEET_GENERATOR_HPP
@@ -14,22 +14,31 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
-#ifdef HAS_CODECVT
-#include <codecvt>
-#include <locale>
-#endif
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <limits>
 #include <map>
+#include <memory>
+#include <memory_resource>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <typeinfo>
 #include <vector>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define RAPIDCSV_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace rapidcsv
 {
@@ -39,6 +48,7 @@ namespace rapidcsv
   static const bool sPlatformHasCR = false;
 #endif
   static const std::vector<char> s_Utf8BOM = { '\xef', '\xbb', '\xbf' };
+  static const size_t sParseChunkMinSize = 512 * 1024;
 
   /**
    * @brief     Datastructure holding parameters controlling how invalid numbers (including
@@ -560,6 +570,96 @@ namespace rapidcsv
       ReadCsv(pStream);
     }
 
+    /**
+     * @brief   Read Document data from memory.
+     * @param   pData                 specifies the complete contents of a CSV-file, the Document takes
+     *                                ownership of the buffer.
+     * @param   pLabelParams          specifies which row and column should be treated as labels.
+     * @param   pSeparatorParams      specifies which field and row separators should be used.
+     * @param   pConverterParams      specifies how invalid numbers (including empty strings) should be
+     *                                handled.
+     * @param   pLineReaderParams     specifies how special line formats should be treated.
+     */
+    void Load(std::vector<char>&& pData,
+              const LabelParams& pLabelParams = LabelParams(),
+              const SeparatorParams& pSeparatorParams = SeparatorParams(),
+              const ConverterParams& pConverterParams = ConverterParams(),
+              const LineReaderParams& pLineReaderParams = LineReaderParams())
+    {
+      mPath = "";
+      mLabelParams = pLabelParams;
+      mSeparatorParams = pSeparatorParams;
+      mConverterParams = pConverterParams;
+      mLineReaderParams = pLineReaderParams;
+      ReadCsv(std::move(pData));
+    }
+
+    /**
+     * @brief   Read Document data row by row, e.g. from a spreadsheet file of another format.
+     * @param   pReadRow              replaces the cells of its argument with those of the next row,
+     *                                returns false after the last row. Shorter rows are padded with
+     *                                empty cells to the widest one.
+     * @param   pLabelParams          specifies which row and column should be treated as labels.
+     * @param   pSeparatorParams      specifies which field and row separators Save should use.
+     * @param   pConverterParams      specifies how invalid numbers (including empty strings) should be
+     *                                handled.
+     * @param   pLineReaderParams     specifies how empty and comment rows should be treated.
+     */
+    void LoadRows(const std::function<bool(std::vector<std::string>&)>& pReadRow,
+                  const LabelParams& pLabelParams = LabelParams(),
+                  const SeparatorParams& pSeparatorParams = SeparatorParams(),
+                  const ConverterParams& pConverterParams = ConverterParams(),
+                  const LineReaderParams& pLineReaderParams = LineReaderParams())
+    {
+      mPath = "";
+      mLabelParams = pLabelParams;
+      mSeparatorParams = pSeparatorParams;
+      mConverterParams = pConverterParams;
+      mLineReaderParams = pLineReaderParams;
+      Clear();
+
+      mArenas.push_back(std::make_shared<std::pmr::monotonic_buffer_resource>(sParseChunkMinSize));
+      std::pmr::memory_resource* resource = mArenas.back().get();
+      std::vector<std::string> cells;
+      size_t columnCount = 1;
+      while (pReadRow(cells))
+      {
+        // an empty row reads as a single empty cell, like an empty line
+        const bool isEmpty = cells.empty() || ((cells.size() == 1) && cells[0].empty());
+        if (isEmpty && mLineReaderParams.mSkipEmptyLines)
+        {
+          continue;
+        }
+        if (!isEmpty && mLineReaderParams.mSkipCommentLines && !cells[0].empty() &&
+            (cells[0][0] == mLineReaderParams.mCommentPrefix))
+        {
+          continue;
+        }
+
+        Row row(resource);
+        row.reserve(std::max<size_t>(cells.size(), 1));
+        for (const std::string& cell : cells)
+        {
+          row.emplace_back(cell.data(), cell.size());
+        }
+        if (row.empty())
+        {
+          row.emplace_back();
+        }
+        columnCount = std::max(columnCount, row.size());
+        mData.push_back(std::move(row));
+      }
+
+      // spreadsheets leave trailing empty cells out, which CSV exports write
+      for (Row& row : mData)
+      {
+        row.resize(columnCount);
+      }
+
+      UpdateColumnNames();
+      UpdateRowNames();
+    }
+
     /**
      * @brief   Write Document data to file.
      * @param   pPath                 optionally specifies the path where the CSV-file will be created
@@ -593,10 +693,10 @@ namespace rapidcsv
       mData.clear();
       mColumnNames.clear();
       mRowNames.clear();
-#ifdef HAS_CODECVT
+      // cells of the previous data live in the arenas, release them in one shot
+      mArenas.clear();
       mIsUtf16 = false;
       mIsLE = false;
-#endif
       mHasUtf8BOM = false;
     }
 
@@ -635,7 +735,7 @@ namespace rapidcsv
           if (dataColumnIdx < itRow->size())
           {
             T val;
-            converter.ToVal(itRow->at(dataColumnIdx), val);
+            CellToVal(converter, itRow->at(dataColumnIdx), val);
             column.push_back(val);
           }
           else
@@ -669,7 +769,7 @@ namespace rapidcsv
         if (std::distance(mData.begin(), itRow) > mLabelParams.mColumnNameIdx)
         {
           T val;
-          pToVal(itRow->at(dataColumnIdx), val);
+          pToVal(std::string(itRow->at(dataColumnIdx)), val);
           column.push_back(val);
         }
       }
@@ -721,9 +821,9 @@ namespace rapidcsv
 
       while (GetDataRowIndex(pColumn.size()) > GetDataRowCount())
       {
-        std::vector<std::string> row;
+        Row row;
         row.resize(GetDataColumnCount());
-        mData.push_back(row);
+        mData.push_back(std::move(row));
       }
 
       if ((dataColumnIdx + 1) > GetDataColumnCount())
@@ -808,7 +908,7 @@ namespace rapidcsv
     {
       const size_t dataColumnIdx = GetDataColumnIndex(pColumnIdx);
 
-      std::vector<std::string> column;
+      std::vector<Cell> column;
       if (pColumn.empty())
       {
         column.resize(GetDataRowCount());
@@ -829,11 +929,11 @@ namespace rapidcsv
 
       while (column.size() > GetDataRowCount())
       {
-        std::vector<std::string> row;
+        Row row;
         const size_t columnCount = std::max<size_t>(static_cast<size_t>(mLabelParams.mColumnNameIdx + 1),
                                                     GetDataColumnCount());
         row.resize(columnCount);
-        mData.push_back(row);
+        mData.push_back(std::move(row));
       }
 
       for (auto itRow = mData.begin(); itRow != mData.end(); ++itRow)
@@ -897,7 +997,7 @@ namespace rapidcsv
         if (std::distance(mData.at(dataRowIdx).begin(), itCol) > mLabelParams.mRowNameIdx)
         {
           T val;
-          converter.ToVal(*itCol, val);
+          CellToVal(converter, *itCol, val);
           row.push_back(val);
         }
       }
@@ -921,7 +1021,7 @@ namespace rapidcsv
         if (std::distance(mData.at(dataRowIdx).begin(), itCol) > mLabelParams.mRowNameIdx)
         {
           T val;
-          pToVal(*itCol, val);
+          pToVal(std::string(*itCol), val);
           row.push_back(val);
         }
       }
@@ -973,9 +1073,9 @@ namespace rapidcsv
 
       while ((dataRowIdx + 1) > GetDataRowCount())
       {
-        std::vector<std::string> row;
+        Row row;
         row.resize(GetDataColumnCount());
-        mData.push_back(row);
+        mData.push_back(std::move(row));
       }
 
       if (pRow.size() > GetDataColumnCount())
@@ -1053,7 +1153,7 @@ namespace rapidcsv
     {
       const size_t rowIdx = GetDataRowIndex(pRowIdx);
 
-      std::vector<std::string> row;
+      Row row;
       if (pRow.empty())
       {
         row.resize(GetDataColumnCount());
@@ -1072,12 +1172,12 @@ namespace rapidcsv
 
       while (rowIdx > GetDataRowCount())
       {
-        std::vector<std::string> tempRow;
+        Row tempRow;
         tempRow.resize(GetDataColumnCount());
-        mData.push_back(tempRow);
+        mData.push_back(std::move(tempRow));
       }
 
-      mData.insert(mData.begin() + static_cast<int>(rowIdx), row);
+      mData.insert(mData.begin() + static_cast<int>(rowIdx), std::move(row));
 
       if (!pRowName.empty())
       {
@@ -1111,7 +1211,7 @@ namespace rapidcsv
 
       T val;
       Converter<T> converter(mConverterParams);
-      converter.ToVal(mData.at(dataRowIdx).at(dataColumnIdx), val);
+      CellToVal(converter, mData.at(dataRowIdx).at(dataColumnIdx), val);
       return val;
     }
 
@@ -1129,7 +1229,7 @@ namespace rapidcsv
       const size_t dataRowIdx = GetDataRowIndex(pRowIdx);
 
       T val;
-      pToVal(mData.at(dataRowIdx).at(dataColumnIdx), val);
+      pToVal(std::string(mData.at(dataRowIdx).at(dataColumnIdx)), val);
       return val;
     }
 
@@ -1270,9 +1370,9 @@ namespace rapidcsv
 
       while ((dataRowIdx + 1) > GetDataRowCount())
       {
-        std::vector<std::string> row;
+        Row row;
         row.resize(GetDataColumnCount());
-        mData.push_back(row);
+        mData.push_back(std::move(row));
       }
 
       if ((dataColumnIdx + 1) > GetDataColumnCount())
@@ -1365,7 +1465,7 @@ namespace rapidcsv
         throw std::out_of_range("column name row index < 0: " + std::to_string(mLabelParams.mColumnNameIdx));
       }
 
-      return mData.at(static_cast<size_t>(mLabelParams.mColumnNameIdx)).at(dataColumnIdx);
+      return std::string(mData.at(static_cast<size_t>(mLabelParams.mColumnNameIdx)).at(dataColumnIdx));
     }
 
     /**
@@ -1427,7 +1527,7 @@ namespace rapidcsv
         throw std::out_of_range("row name column index < 0: " + std::to_string(mLabelParams.mRowNameIdx));
       }
 
-      return mData.at(dataRowIdx).at(static_cast<size_t>(mLabelParams.mRowNameIdx));
+      return std::string(mData.at(dataRowIdx).at(static_cast<size_t>(mLabelParams.mRowNameIdx)));
     }
 
     /**
@@ -1471,7 +1571,7 @@ namespace rapidcsv
         {
           if (std::distance(mData.begin(), itRow) > mLabelParams.mColumnNameIdx)
           {
-            rownames.push_back(itRow->at(static_cast<size_t>(mLabelParams.mRowNameIdx)));
+            rownames.emplace_back(itRow->at(static_cast<size_t>(mLabelParams.mRowNameIdx)));
           }
         }
       }
@@ -1479,6 +1579,70 @@ namespace rapidcsv
     }
 
   private:
+    // Cells and rows produced by parsing are allocated from mArenas, which are released as a
+    // whole when the document is cleared or destroyed. Rows added through the Set/Insert
+    // functions use the default resource.
+    typedef std::pmr::string Cell;
+    typedef std::pmr::vector<Cell> Row;
+
+    // Parser state of one chunk.
+    struct ParseState
+    {
+      explicit ParseState(std::pmr::memory_resource* pResource)
+        : mRows()
+        , mRow(pResource)
+        , mCell()
+        , mQuoted(false)
+        , mColumnCount(0)
+        , mCR(0)
+        , mLF(0)
+      {
+      }
+
+      bool AtRowStart() const
+      {
+        return mRow.empty() && mCell.empty() && !mQuoted;
+      }
+
+      std::vector<Row> mRows;
+      Row mRow;
+      std::string mCell;
+      bool mQuoted;
+      size_t mColumnCount;
+      int mCR;
+      int mLF;
+    };
+
+    // Bytes that end a run of plain cell text: the separator, the quote char and line breaks.
+    static constexpr std::array<bool, 256> SpecialBytes(const char pSeparator, const char pQuoteChar)
+    {
+      std::array<bool, 256> specialBytes{};
+      specialBytes[static_cast<unsigned char>(pSeparator)] = true;
+      specialBytes[static_cast<unsigned char>(pQuoteChar)] = true;
+      specialBytes[static_cast<unsigned char>('\r')] = true;
+      specialBytes[static_cast<unsigned char>('\n')] = true;
+      return specialBytes;
+    }
+
+    // Dialect read from the separator parameters, with a table of the bytes ending plain text.
+    struct RuntimeDialect
+    {
+      explicit RuntimeDialect(const SeparatorParams& pParams)
+        : mParams(pParams)
+        , mSpecialBytes(SpecialBytes(pParams.mSeparator, pParams.mQuoteChar))
+      {
+      }
+
+      char Separator() const { return mParams.mSeparator; }
+      char QuoteChar() const { return mParams.mQuoteChar; }
+      bool Trim() const { return mParams.mTrim; }
+      bool QuotedLinebreaks() const { return mParams.mQuotedLinebreaks; }
+      bool IsSpecial(const char pChar) const { return mSpecialBytes[static_cast<unsigned char>(pChar)]; }
+
+      const SeparatorParams& mParams;
+      std::array<bool, 256> mSpecialBytes;
+    };
+
     void ReadCsv()
     {
       std::ifstream stream;
@@ -1489,249 +1653,281 @@ namespace rapidcsv
 
     void ReadCsv(std::istream& pStream)
     {
-      Clear();
       pStream.seekg(0, std::ios::end);
       std::streamsize length = pStream.tellg();
       pStream.seekg(0, std::ios::beg);
 
-#ifdef HAS_CODECVT
-      std::vector<char> bom2b(2, '\0');
-      if (length >= 2)
+      std::vector<char> buffer(static_cast<size_t>(std::max<std::streamsize>(length, 0)));
+      if (!buffer.empty())
       {
-        pStream.read(bom2b.data(), 2);
-        pStream.seekg(0, std::ios::beg);
+        pStream.read(buffer.data(), length);
       }
 
+      // With user-specified istream opened in non-binary mode on windows, we may have a
+      // data length mismatch, so ensure we don't parse outside actual data length read.
+      const std::streamsize readLength = buffer.empty() ? 0 : pStream.gcount();
+      buffer.resize(static_cast<size_t>(std::max<std::streamsize>(readLength, 0)));
+
+      ReadCsv(std::move(buffer));
+    }
+
+    void ReadCsv(std::vector<char>&& pData)
+    {
+      Clear();
+      std::vector<char> buffer = std::move(pData);
+
       static const std::vector<char> bomU16le = { '\xff', '\xfe' };
       static const std::vector<char> bomU16be = { '\xfe', '\xff' };
-      if ((bom2b == bomU16le) || (bom2b == bomU16be))
+      if ((buffer.size() >= 2) &&
+          (std::equal(bomU16le.begin(), bomU16le.end(), buffer.begin()) ||
+           std::equal(bomU16be.begin(), bomU16be.end(), buffer.begin())))
       {
         mIsUtf16 = true;
-        mIsLE = (bom2b == bomU16le);
+        mIsLE = (buffer[0] == bomU16le[0]);
 
-        std::wifstream wstream;
-        wstream.exceptions(std::wifstream::failbit | std::wifstream::badbit);
-        wstream.open(mPath, std::ios::binary);
-        if (mIsLE)
-        {
-          wstream.imbue(std::locale(wstream.getloc(),
-                                    new std::codecvt_utf16<wchar_t, 0x10ffff,
-                                                           static_cast<std::codecvt_mode>(std::consume_header |
-                                                                                          std::little_endian)>));
-        }
-        else
-        {
-          wstream.imbue(std::locale(wstream.getloc(),
-                                    new std::codecvt_utf16<wchar_t, 0x10ffff,
-                                                           std::consume_header>));
-        }
-        std::wstringstream wss;
-        wss << wstream.rdbuf();
-        std::string utf8 = ToString(wss.str());
-        std::stringstream ss(utf8);
-        ParseCsv(ss, static_cast<std::streamsize>(utf8.size()));
+        const std::vector<char> utf8 = Utf16ToUtf8(buffer.data() + 2, buffer.size() - 2, mIsLE);
+        buffer.clear();
+        buffer.shrink_to_fit();
+        ParseCsv(utf8.data(), utf8.size());
       }
       else
-#endif
       {
         // check for UTF-8 Byte order mark and skip it when found
-        if (length >= 3)
+        size_t offset = 0;
+        if ((buffer.size() >= 3) && std::equal(s_Utf8BOM.begin(), s_Utf8BOM.end(), buffer.begin()))
         {
-          std::vector<char> bom3b(3, '\0');
-          pStream.read(bom3b.data(), 3);
-
-          if (bom3b != s_Utf8BOM)
-          {
-            // file does not start with a UTF-8 Byte order mark
-            pStream.seekg(0, std::ios::beg);
-          }
-          else
-          {
-            // file did start with a UTF-8 Byte order mark, simply skip it
-            length -= 3;
-            mHasUtf8BOM = true;
-          }
+          offset = 3;
+          mHasUtf8BOM = true;
         }
 
-        ParseCsv(pStream, length);
+        ParseCsv(buffer.data() + offset, buffer.size() - offset);
       }
     }
 
-    void ParseCsv(std::istream& pStream, std::streamsize p_FileLength)
+    void ParseCsv(const char* pData, const size_t pLength)
     {
-      const std::streamsize bufLength = 64 * 1024;
-      std::vector<char> buffer(bufLength);
-      std::vector<std::string> row;
-      std::string cell;
-      bool quoted = false;
+      // Split the data into one chunk per core, each starting right after a line break.
+      // Chunks are parsed concurrently assuming they start on a fresh row; that guess is
+      // verified when stitching and the chunk is re-parsed from the real state if the
+      // boundary turned out to fall inside a quoted multi-line cell.
+      const size_t threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+      const size_t chunkCount = std::max<size_t>(std::min(threadCount, pLength / sParseChunkMinSize), 1);
+      std::vector<size_t> bounds(1, 0);
+      for (size_t k = 1; k < chunkCount; ++k)
+      {
+        const size_t splitPos = std::max(pLength * k / chunkCount, bounds.back());
+        const void* lineBreak = std::memchr(pData + splitPos, '\n', pLength - splitPos);
+        if (lineBreak == nullptr)
+        {
+          break;
+        }
+
+        const size_t bound = static_cast<size_t>(static_cast<const char*>(lineBreak) - pData) + 1;
+        if (bound < pLength)
+        {
+          bounds.push_back(bound);
+        }
+      }
+      bounds.push_back(pLength);
+
+      // each chunk allocates its cells from its own arena, the document keeps them all alive
+      std::vector<ParseState> states;
+      states.reserve(bounds.size() - 1);
+      mArenas.clear();
+      for (size_t k = 0; k + 1 < bounds.size(); ++k)
+      {
+        mArenas.push_back(std::make_shared<std::pmr::monotonic_buffer_resource>(
+                            std::max<size_t>(bounds[k + 1] - bounds[k], 1024)));
+        states.emplace_back(mArenas.back().get());
+      }
+
       int cr = 0;
       int lf = 0;
+      ParseChunks(pData, bounds, states, RuntimeDialect(mSeparatorParams), cr, lf);
+
+      // Assume CR/LF if at least half the linebreaks have CR
+      mSeparatorParams.mHasCR = (cr > (lf / 2));
 
-      while (p_FileLength > 0)
+      // Set up column labels
+      UpdateColumnNames();
+
+      // Set up row labels
+      UpdateRowNames();
+    }
+
+    void ParseChunks(const char* pData, const std::vector<size_t>& pBounds, std::vector<ParseState>& pStates,
+                     const RuntimeDialect& pDialect, int& pCR, int& pLF)
+    {
+      std::vector<std::future<void>> futures;
+      for (size_t k = 1; k < pStates.size(); ++k)
       {
-        const std::streamsize toReadLength = std::min<std::streamsize>(p_FileLength, bufLength);
-        pStream.read(buffer.data(), toReadLength);
+        futures.push_back(std::async(std::launch::async, [this, pData, &pBounds, &pStates, &pDialect, k]()
+        {
+          ParseChunk(pData + pBounds[k], pData + pBounds[k + 1], pStates[k], pDialect);
+        }));
+      }
+      ParseChunk(pData + pBounds[0], pData + pBounds[1], pStates[0], pDialect);
+      for (auto& future : futures)
+      {
+        future.get();
+      }
 
-        // With user-specified istream opened in non-binary mode on windows, we may have a
-        // data length mismatch, so ensure we don't parse outside actual data length read.
-        const std::streamsize readLength = pStream.gcount();
-        if (readLength <= 0)
+      // Stitch rows in order
+      ParseState* state = &pStates.front();
+      for (size_t k = 1; k < pStates.size(); ++k)
+      {
+        if (state->AtRowStart())
         {
-          break;
+          AppendRows(*state, pCR, pLF);
+          state = &pStates[k];
         }
+        else
+        {
+          // boundary inside a quoted cell, the speculative parse of this chunk is void
+          ParseChunk(pData + pBounds[k], pData + pBounds[k + 1], *state, pDialect);
+        }
+      }
+
+      // Handle last row / cell without linebreak
+      if (state->mRow.empty() && state->mCell.empty())
+      {
+        // skip empty trailing line
+      }
+      else
+      {
+        EndRow(*state);
+      }
+      AppendRows(*state, pCR, pLF);
+    }
 
-        for (size_t i = 0; i < static_cast<size_t>(readLength); ++i)
+    void ParseChunk(const char* pBegin, const char* pEnd, ParseState& pState, const RuntimeDialect& pDialect) const
+    {
+      std::string& cell = pState.mCell;
+      for (const char* it = pBegin; it != pEnd; ++it)
+      {
+        if (!pDialect.IsSpecial(*it))
         {
-          if (buffer[i] == mSeparatorParams.mQuoteChar)
+          // append the run of plain text up to the next special byte at once
+          const char* runEnd = it + 1;
+          while ((runEnd != pEnd) && !pDialect.IsSpecial(*runEnd))
           {
-            if (cell.empty() || (cell[0] == mSeparatorParams.mQuoteChar))
-            {
-              quoted = !quoted;
-            }
-            else if (mSeparatorParams.mTrim)
-            {
-              // allow whitespace before first mQuoteChar
-              const auto firstQuote = std::find(cell.begin(), cell.end(), mSeparatorParams.mQuoteChar);
-              if (std::all_of(cell.begin(), firstQuote, [](int ch) { return isspace(ch); }))
-              {
-                quoted = !quoted;
-              }
-            }
-            cell += buffer[i];
+            ++runEnd;
           }
-          else if (buffer[i] == mSeparatorParams.mSeparator)
+          cell.append(it, runEnd);
+          it = runEnd - 1;
+        }
+        else if (*it == pDialect.QuoteChar())
+        {
+          if (cell.empty() || (cell[0] == pDialect.QuoteChar()))
           {
-            if (!quoted)
-            {
-              row.push_back(Unquote(Trim(cell)));
-              cell.clear();
-            }
-            else
-            {
-              cell += buffer[i];
-            }
+            pState.mQuoted = !pState.mQuoted;
           }
-          else if (buffer[i] == '\r')
+          else if (pDialect.Trim())
           {
-            if (mSeparatorParams.mQuotedLinebreaks && quoted)
+            // allow whitespace before first mQuoteChar
+            const auto firstQuote = std::find(cell.begin(), cell.end(), pDialect.QuoteChar());
+            if (std::all_of(cell.begin(), firstQuote, [](unsigned char ch) { return isspace(ch) != 0; }))
             {
-              cell += buffer[i];
-            }
-            else
-            {
-              ++cr;
+              pState.mQuoted = !pState.mQuoted;
             }
           }
-          else if (buffer[i] == '\n')
+          cell += *it;
+        }
+        else if (*it == pDialect.Separator())
+        {
+          if (!pState.mQuoted)
+          {
+            pState.mRow.push_back(FinalizeCell(cell, pState.mRow.get_allocator()));
+            cell.clear();
+          }
+          else
+          {
+            cell += *it;
+          }
+        }
+        else if (*it == '\r')
+        {
+          if (pDialect.QuotedLinebreaks() && pState.mQuoted)
+          {
+            cell += *it;
+          }
+          else
+          {
+            ++pState.mCR;
+          }
+        }
+        else // '\n', the last special byte
+        {
+          if (pDialect.QuotedLinebreaks() && pState.mQuoted)
           {
-            if (mSeparatorParams.mQuotedLinebreaks && quoted)
+            cell += *it;
+          }
+          else
+          {
+            ++pState.mLF;
+            if (mLineReaderParams.mSkipEmptyLines && pState.mRow.empty() && cell.empty())
             {
-              cell += buffer[i];
+              // skip empty line
             }
             else
             {
-              ++lf;
-              if (mLineReaderParams.mSkipEmptyLines && row.empty() && cell.empty())
-              {
-                // skip empty line
-              }
-              else
-              {
-                row.push_back(Unquote(Trim(cell)));
-
-                if (mLineReaderParams.mSkipCommentLines && !row.at(0).empty() &&
-                    (row.at(0)[0] == mLineReaderParams.mCommentPrefix))
-                {
-                  // skip comment line
-                }
-                else
-                {
-                  mData.push_back(row);
-                }
-
-                cell.clear();
-                row.clear();
-                quoted = false;
-              }
+              EndRow(pState);
             }
           }
-          else
-          {
-            cell += buffer[i];
-          }
         }
-        p_FileLength -= readLength;
       }
+    }
 
-      // Handle last row / cell without linebreak
-      if (row.empty() && cell.empty())
+    void EndRow(ParseState& pState) const
+    {
+      Row& row = pState.mRow;
+      row.push_back(FinalizeCell(pState.mCell, row.get_allocator()));
+      pState.mColumnCount = std::max(pState.mColumnCount, row.size());
+
+      if (mLineReaderParams.mSkipCommentLines && !row.at(0).empty() &&
+          (row.at(0)[0] == mLineReaderParams.mCommentPrefix))
       {
-        // skip empty trailing line
+        // skip comment line
       }
       else
       {
-        row.push_back(Unquote(Trim(cell)));
-
-        if (mLineReaderParams.mSkipCommentLines && !row.at(0).empty() &&
-            (row.at(0)[0] == mLineReaderParams.mCommentPrefix))
-        {
-          // skip comment line
-        }
-        else
-        {
-          mData.push_back(row);
-        }
-
-        cell.clear();
-        row.clear();
-        quoted = false;
+        pState.mRows.push_back(std::move(row));
       }
 
-      // Assume CR/LF if at least half the linebreaks have CR
-      mSeparatorParams.mHasCR = (cr > (lf / 2));
-
-      // Set up column labels
-      UpdateColumnNames();
+      pState.mCell.clear();
+      row.clear();
+      row.reserve(pState.mColumnCount);
+      pState.mQuoted = false;
+    }
 
-      // Set up row labels
-      UpdateRowNames();
+    void AppendRows(ParseState& pState, int& pCR, int& pLF)
+    {
+      mData.reserve(mData.size() + pState.mRows.size());
+      std::move(pState.mRows.begin(), pState.mRows.end(), std::back_inserter(mData));
+      pState.mRows.clear();
+      pCR += pState.mCR;
+      pLF += pState.mLF;
+      pState.mCR = 0;
+      pState.mLF = 0;
     }
 
     void WriteCsv() const
     {
-#ifdef HAS_CODECVT
+      std::ofstream stream;
+      stream.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+      stream.open(mPath, std::ios::binary | std::ios::trunc);
       if (mIsUtf16)
       {
         std::stringstream ss;
         WriteCsv(ss);
-        std::string utf8 = ss.str();
-        std::wstring wstr = ToWString(utf8);
+        const std::string utf16 = Utf8ToUtf16(ss.str(), mIsLE);
 
-        std::wofstream wstream;
-        wstream.exceptions(std::wofstream::failbit | std::wofstream::badbit);
-        wstream.open(mPath, std::ios::binary | std::ios::trunc);
-
-        if (mIsLE)
-        {
-          wstream.imbue(std::locale(wstream.getloc(),
-                                    new std::codecvt_utf16<wchar_t, 0x10ffff,
-                                                           static_cast<std::codecvt_mode>(std::little_endian)>));
-        }
-        else
-        {
-          wstream.imbue(std::locale(wstream.getloc(),
-                                    new std::codecvt_utf16<wchar_t, 0x10ffff>));
-        }
-
-        wstream << static_cast<wchar_t>(0xfeff);
-        wstream << wstr;
+        const char bom[2] = { mIsLE ? '\xff' : '\xfe', mIsLE ? '\xfe' : '\xff' };
+        stream.write(bom, 2);
+        stream.write(utf16.data(), static_cast<std::streamsize>(utf16.size()));
       }
       else
-#endif
       {
-        std::ofstream stream;
-        stream.exceptions(std::ofstream::failbit | std::ofstream::badbit);
-        stream.open(mPath, std::ios::binary | std::ios::trunc);
         if (mHasUtf8BOM)
         {
           stream.write(s_Utf8BOM.data(), 3);
@@ -1750,10 +1946,12 @@ namespace rapidcsv
           if (mSeparatorParams.mAutoQuote &&
               ((itc->find(mSeparatorParams.mSeparator) != std::string::npos) ||
                (itc->find(' ') != std::string::npos) ||
-               (itc->find('\n') != std::string::npos)))
+               (itc->find('\n') != std::string::npos) ||
+               (itc->find('\r') != std::string::npos) ||
+               (itc->find(mSeparatorParams.mQuoteChar) != std::string::npos)))
           {
             // escape quotes in string
-            std::string str = *itc;
+            std::string str(*itc);
             const std::string quoteCharStr = std::string(1, mSeparatorParams.mQuoteChar);
             ReplaceString(str, quoteCharStr, quoteCharStr + quoteCharStr);
 
@@ -1796,45 +1994,73 @@ namespace rapidcsv
       return pColumnIdx + firstDataColumn;
     }
 
-    std::string Trim(const std::string& pStr) const
+    template<typename T>
+    static void CellToVal(const Converter<T>& pConverter, const Cell& pCell, T& pVal)
     {
-      if (mSeparatorParams.mTrim)
-      {
-        std::string str = pStr;
-
-        // ltrim
-        str.erase(str.begin(), std::find_if(str.begin(), str.end(), [](int ch) { return !isspace(ch); }));
+      pConverter.ToVal(std::string(pCell), pVal);
+    }
 
-        // rtrim
-        str.erase(std::find_if(str.rbegin(), str.rend(), [](int ch) { return !isspace(ch); }).base(), str.end());
+    static void CellToVal(const Converter<std::string>& /*pConverter*/, const Cell& pCell, std::string& pVal)
+    {
+      pVal.assign(pCell.data(), pCell.size());
+    }
 
-        return str;
-      }
-      else
-      {
-        return pStr;
-      }
+    // std::string_view cells refer to the document data, they stay valid until the cell is
+    // modified or the document is cleared
+    static void CellToVal(const Converter<std::string_view>& /*pConverter*/, const Cell& pCell,
+                          std::string_view& pVal)
+    {
+      pVal = pCell;
     }
 
-    std::string Unquote(const std::string& pStr) const
+    // Trim and unquote a parsed cell into its final storage, writing it once: trimming and the
+    // outer quotes only narrow the range, doubled quotes are collapsed while copying.
+    Cell FinalizeCell(const std::string& pStr, const Cell::allocator_type& pAlloc) const
     {
-      if (mSeparatorParams.mAutoQuote && (pStr.size() >= 2) &&
-          (pStr.front() == mSeparatorParams.mQuoteChar) &&
-          (pStr.back() == mSeparatorParams.mQuoteChar))
+      const char* first = pStr.data();
+      const char* last = pStr.data() + pStr.size();
+      if (mSeparatorParams.mTrim)
       {
-        // remove start/end quotes
-        std::string str = pStr.substr(1, pStr.size() - 2);
+        while ((first != last) && isspace(static_cast<unsigned char>(*first)))
+        {
+          ++first;
+        }
+        while ((last != first) && isspace(static_cast<unsigned char>(*(last - 1))))
+        {
+          --last;
+        }
+      }
 
-        // unescape quotes in string
-        const std::string quoteCharStr = std::string(1, mSeparatorParams.mQuoteChar);
-        ReplaceString(str, quoteCharStr + quoteCharStr, quoteCharStr);
+      const char quoteChar = mSeparatorParams.mQuoteChar;
+      if (!mSeparatorParams.mAutoQuote || ((last - first) < 2) || (*first != quoteChar) || (*(last - 1) != quoteChar))
+      {
+        return Cell(first, static_cast<size_t>(last - first), pAlloc);
+      }
 
-        return str;
+      // remove start/end quotes
+      ++first;
+      --last;
+      const char* quote = static_cast<const char*>(std::memchr(first, quoteChar, static_cast<size_t>(last - first)));
+      if (quote == nullptr)
+      {
+        return Cell(first, static_cast<size_t>(last - first), pAlloc);
       }
-      else
+
+      // unescape quotes in string
+      Cell cell(pAlloc);
+      cell.reserve(static_cast<size_t>(last - first));
+      while (quote != nullptr)
       {
-        return pStr;
+        cell.append(first, quote + 1);
+        first = quote + 1;
+        if ((first != last) && (*first == quoteChar))
+        {
+          ++first;
+        }
+        quote = static_cast<const char*>(std::memchr(first, quoteChar, static_cast<size_t>(last - first)));
       }
+      cell.append(first, last);
+      return cell;
     }
 
     void UpdateColumnNames()
@@ -1846,7 +2072,7 @@ namespace rapidcsv
         size_t i = 0;
         for (auto& columnName : mData[static_cast<size_t>(mLabelParams.mColumnNameIdx)])
         {
-          mColumnNames[columnName] = i++;
+          mColumnNames[std::string(columnName)] = i++;
         }
       }
     }
@@ -1863,32 +2089,180 @@ namespace rapidcsv
         {
           if (static_cast<int>(dataRow.size()) > mLabelParams.mRowNameIdx)
           {
-            mRowNames[dataRow[static_cast<size_t>(mLabelParams.mRowNameIdx)]] = i++;
+            mRowNames[std::string(dataRow[static_cast<size_t>(mLabelParams.mRowNameIdx)])] = i++;
           }
         }
       }
     }
 
-#ifdef HAS_CODECVT
-#if defined(_MSC_VER)
-#pragma warning (push)
-#pragma warning (disable: 4996)
+    /**
+     * @brief   Transcode UTF-16 to UTF-8 in a single pass. Runs of ASCII code units are
+     *          narrowed eight at a time with SSE2, unpaired surrogates and a dangling odd
+     *          byte become U+FFFD.
+     */
+    static std::vector<char> Utf16ToUtf8(const char* pData, const size_t pLength, const bool pIsLE)
+    {
+      const unsigned char* src = reinterpret_cast<const unsigned char*>(pData);
+      const size_t unitCount = pLength / 2;
+      auto unitAt = [src, pIsLE](const size_t pIdx) -> uint32_t
+      {
+        const uint32_t b0 = src[2 * pIdx];
+        const uint32_t b1 = src[2 * pIdx + 1];
+        return pIsLE ? (b0 | (b1 << 8)) : ((b0 << 8) | b1);
+      };
+
+      // a code unit never takes more than 3 bytes, a surrogate pair takes 4 for 2 units
+      std::vector<char> out(unitCount * 3 + 3);
+      char* dst = out.data();
+      size_t i = 0;
+      while (i < unitCount)
+      {
+#ifdef RAPIDCSV_SSE2
+        if (i + 8 <= unitCount)
+        {
+          __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+          if (!pIsLE)
+          {
+            units = _mm_or_si128(_mm_slli_epi16(units, 8), _mm_srli_epi16(units, 8));
+          }
+
+          const __m128i nonAscii = _mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xff80)));
+          if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonAscii, _mm_setzero_si128())) == 0xffff)
+          {
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(units, units));
+            dst += 8;
+            i += 8;
+            continue;
+          }
+        }
 #endif
-    static std::string ToString(const std::wstring& pWStr)
+
+        // scalar decode up to the next block boundary
+        const size_t blockEnd = std::min(i + 8, unitCount);
+        while (i < blockEnd)
+        {
+          uint32_t cp = unitAt(i++);
+          if ((cp >= 0xd800) && (cp <= 0xdbff) && (i < unitCount) &&
+              (unitAt(i) >= 0xdc00) && (unitAt(i) <= 0xdfff))
+          {
+            cp = 0x10000 + ((cp - 0xd800) << 10) + (unitAt(i++) - 0xdc00);
+          }
+          else if ((cp >= 0xd800) && (cp <= 0xdfff))
+          {
+            cp = 0xfffd;
+          }
+          dst = EncodeUtf8(cp, dst);
+        }
+      }
+
+      if (pLength % 2 != 0)
+      {
+        dst = EncodeUtf8(0xfffd, dst);
+      }
+
+      out.resize(static_cast<size_t>(dst - out.data()));
+      return out;
+    }
+
+    /**
+     * @brief   Transcode UTF-8 to UTF-16, invalid sequences become U+FFFD.
+     */
+    static std::string Utf8ToUtf16(const std::string& pStr, const bool pIsLE)
     {
-      return std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>{ }.to_bytes(pWStr);
+      std::string out;
+      out.reserve(pStr.size() * 2);
+      auto putUnit = [&out, pIsLE](const uint32_t pUnit)
+      {
+        const char lo = static_cast<char>(pUnit & 0xff);
+        const char hi = static_cast<char>((pUnit >> 8) & 0xff);
+        out += pIsLE ? lo : hi;
+        out += pIsLE ? hi : lo;
+      };
+
+      const unsigned char* src = reinterpret_cast<const unsigned char*>(pStr.data());
+      const size_t length = pStr.size();
+      size_t i = 0;
+      while (i < length)
+      {
+        const uint32_t lead = src[i];
+        size_t count = 0;
+        uint32_t cp = 0xfffd;
+        if (lead < 0x80)
+        {
+          cp = lead;
+        }
+        else if ((lead >= 0xc2) && (lead <= 0xdf))
+        {
+          count = 1;
+          cp = lead & 0x1f;
+        }
+        else if ((lead >= 0xe0) && (lead <= 0xef))
+        {
+          count = 2;
+          cp = lead & 0x0f;
+        }
+        else if ((lead >= 0xf0) && (lead <= 0xf4))
+        {
+          count = 3;
+          cp = lead & 0x07;
+        }
+
+        ++i;
+        size_t j = 0;
+        for (; (j < count) && (i < length) && ((src[i] & 0xc0) == 0x80); ++j, ++i)
+        {
+          cp = (cp << 6) | (src[i] & 0x3f);
+        }
+
+        static const uint32_t minCodePoint[] = { 0, 0x80, 0x800, 0x10000 };
+        if ((j != count) || (cp < minCodePoint[count]) || (cp > 0x10ffff) ||
+            ((cp >= 0xd800) && (cp <= 0xdfff)))
+        {
+          cp = 0xfffd;
+        }
+
+        if (cp >= 0x10000)
+        {
+          putUnit(0xd800 + ((cp - 0x10000) >> 10));
+          putUnit(0xdc00 + ((cp - 0x10000) & 0x3ff));
+        }
+        else
+        {
+          putUnit(cp);
+        }
+      }
+      return out;
     }
 
-    static std::wstring ToWString(const std::string& pStr)
+    static char* EncodeUtf8(const uint32_t pCodePoint, char* pDst)
     {
-      return std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>{ }.from_bytes(pStr);
+      if (pCodePoint < 0x80)
+      {
+        *pDst++ = static_cast<char>(pCodePoint);
+      }
+      else if (pCodePoint < 0x800)
+      {
+        *pDst++ = static_cast<char>(0xc0 | (pCodePoint >> 6));
+        *pDst++ = static_cast<char>(0x80 | (pCodePoint & 0x3f));
+      }
+      else if (pCodePoint < 0x10000)
+      {
+        *pDst++ = static_cast<char>(0xe0 | (pCodePoint >> 12));
+        *pDst++ = static_cast<char>(0x80 | ((pCodePoint >> 6) & 0x3f));
+        *pDst++ = static_cast<char>(0x80 | (pCodePoint & 0x3f));
+      }
+      else
+      {
+        *pDst++ = static_cast<char>(0xf0 | (pCodePoint >> 18));
+        *pDst++ = static_cast<char>(0x80 | ((pCodePoint >> 12) & 0x3f));
+        *pDst++ = static_cast<char>(0x80 | ((pCodePoint >> 6) & 0x3f));
+        *pDst++ = static_cast<char>(0x80 | (pCodePoint & 0x3f));
+      }
+      return pDst;
     }
-#if defined(_MSC_VER)
-#pragma warning (pop)
-#endif
-#endif
 
-    static void ReplaceString(std::string& pStr, const std::string& pSearch, const std::string& pReplace)
+    template<typename S>
+    static void ReplaceString(S& pStr, const std::string& pSearch, const std::string& pReplace)
     {
       size_t pos = 0;
 
@@ -1905,13 +2279,12 @@ namespace rapidcsv
     SeparatorParams mSeparatorParams;
     ConverterParams mConverterParams;
     LineReaderParams mLineReaderParams;
-    std::vector<std::vector<std::string>> mData;
+    std::vector<std::shared_ptr<std::pmr::monotonic_buffer_resource>> mArenas;
+    std::vector<Row> mData;
     std::map<std::string, size_t> mColumnNames;
     std::map<std::string, size_t> mRowNames;
-#ifdef HAS_CODECVT
     bool mIsUtf16 = false;
     bool mIsLE = false;
-#endif
     bool mHasUtf8BOM = false;
   };
 }
@@ -9,6 +9,8 @@
 #include <QFileDialog>
 #include <QSpinBox>
 #include <QCheckBox>
+#include <QLineEdit>
+#include <QComboBox>
 #include <QMessageBox>
 #include <QSettings>
 #include <QClipboard>
@@ -19,10 +21,17 @@
 AppWindow::AppWindow(QWidget *parent) : QWidget(parent)
 {
     setWindowTitle("QPP Console Lang Converter");
-    setFixedSize(640, 360);
+    setFixedSize(640, 560);
     columnNameIndex = 1;
     rowNameIndex = 1;
     shouldReplaceBreakLines = true;
+    shouldRepairInvalidUtf8 = true;
+    shouldNormalizeNfc = false;
+    shouldSortKeys = false;
+    missingTranslation = static_cast<int32_t>(MissingTranslation::Keep);
+    separatorIndex = 0;
+    historySize = 0;
+    formats = "json";
     QString lastSerial;
 
     settings = std::make_unique<QSettings>("settings.ini", QSettings::IniFormat);
@@ -41,6 +50,31 @@ AppWindow::AppWindow(QWidget *parent) : QWidget(parent)
     {
         shouldReplaceBreakLines = shouldReplaceBreakLinesVariant.toBool();
     }
+    QVariant shouldRepairInvalidUtf8Variant = settings->value("shouldRepairInvalidUtf8");
+    if (!shouldRepairInvalidUtf8Variant.isNull())
+    {
+        shouldRepairInvalidUtf8 = shouldRepairInvalidUtf8Variant.toBool();
+    }
+    QVariant shouldNormalizeNfcVariant = settings->value("shouldNormalizeNfc");
+    if (!shouldNormalizeNfcVariant.isNull())
+    {
+        shouldNormalizeNfc = shouldNormalizeNfcVariant.toBool();
+    }
+    QVariant shouldSortKeysVariant = settings->value("shouldSortKeys");
+    if (!shouldSortKeysVariant.isNull())
+    {
+        shouldSortKeys = shouldSortKeysVariant.toBool();
+    }
+    QVariant missingTranslationVariant = settings->value("missingTranslation");
+    if (!missingTranslationVariant.isNull())
+    {
+        missingTranslation = missingTranslationVariant.toInt();
+    }
+    QVariant separatorIndexVariant = settings->value("separatorIndex");
+    if (!separatorIndexVariant.isNull())
+    {
+        separatorIndex = separatorIndexVariant.toInt();
+    }
     QVariant translationFilenameVariant = settings->value("translationFilename");
     if (!translationFilenameVariant.isNull())
     {
@@ -51,6 +85,25 @@ AppWindow::AppWindow(QWidget *parent) : QWidget(parent)
     {
         lastSerial = lastSerialVariant.toString();
     }
+    QVariant serialHistoryVariant = settings->value("serialHistory");
+    if (!serialHistoryVariant.isNull())
+    {
+        serialHistory = serialHistoryVariant.toStringList();
+    }
+    else if (!lastSerial.isEmpty())
+    {
+        serialHistory.append(lastSerial);
+    }
+    QVariant historySizeVariant = settings->value("historySize");
+    if (!historySizeVariant.isNull())
+    {
+        historySize = historySizeVariant.toInt();
+    }
+    QVariant formatsVariant = settings->value("formats");
+    if (!formatsVariant.isNull())
+    {
+        formats = formatsVariant.toString();
+    }
 
     QLabel *filenameLabel = new QLabel("Translation file:", this);
     filenameLabel->setGeometry(20, 20, 80, 40);
@@ -81,12 +134,58 @@ AppWindow::AppWindow(QWidget *parent) : QWidget(parent)
     shouldReplaceBreakLinesCheckBox->setGeometry(20, 200, 160, 40);
     shouldReplaceBreakLinesCheckBox->setChecked(shouldReplaceBreakLines);
 
+    QCheckBox *shouldRepairInvalidUtf8CheckBox = new QCheckBox("Repair invalid UTF-8", this);
+    shouldRepairInvalidUtf8CheckBox->setGeometry(240, 80, 160, 40);
+    shouldRepairInvalidUtf8CheckBox->setChecked(shouldRepairInvalidUtf8);
+
+    QCheckBox *shouldNormalizeNfcCheckBox = new QCheckBox("Normalize to NFC", this);
+    shouldNormalizeNfcCheckBox->setGeometry(240, 140, 160, 40);
+    shouldNormalizeNfcCheckBox->setChecked(shouldNormalizeNfc);
+
+    QCheckBox *shouldSortKeysCheckBox = new QCheckBox("Sort keys", this);
+    shouldSortKeysCheckBox->setGeometry(420, 80, 160, 40);
+    shouldSortKeysCheckBox->setChecked(shouldSortKeys);
+
+    QLabel *historySizeLabel = new QLabel("Delta history:", this);
+    historySizeLabel->setGeometry(420, 140, 90, 40);
+
+    QSpinBox *historySizeSpinBox = new QSpinBox(this);
+    historySizeSpinBox->setGeometry(510, 140, 60, 40);
+    historySizeSpinBox->setValue(historySize);
+
+    QLabel *missingTranslationLabel = new QLabel("Missing translations:", this);
+    missingTranslationLabel->setGeometry(240, 200, 120, 40);
+
+    // Items in the order of MissingTranslation.
+    QComboBox *missingTranslationComboBox = new QComboBox(this);
+    missingTranslationComboBox->setGeometry(360, 205, 140, 30);
+    missingTranslationComboBox->addItem("Keep empty");
+    missingTranslationComboBox->addItem("Omit");
+    missingTranslationComboBox->addItem("Fallback to en");
+    missingTranslationComboBox->setCurrentIndex(missingTranslation);
+
+    // Items after the first in the order of separators, see makeConvertOptions().
+    QComboBox *separatorComboBox = new QComboBox(this);
+    separatorComboBox->setGeometry(510, 205, 110, 30);
+    separatorComboBox->addItem("Detect separator");
+    separatorComboBox->addItem("Comma");
+    separatorComboBox->addItem("Semicolon");
+    separatorComboBox->addItem("Tab");
+    separatorComboBox->addItem("Pipe");
+    separatorComboBox->setCurrentIndex(separatorIndex);
+
     QLabel *serialLabel = new QLabel("Serial:", this);
     serialLabel->setGeometry(20, 260, 60, 40);
     serialTextEdit = new QTextEdit(lastSerial, this);
     serialTextEdit->setReadOnly(true);
     serialTextEdit->setGeometry(80, 265, 200, 30);
 
+    QLabel *formatsLabel = new QLabel("Formats:", this);
+    formatsLabel->setGeometry(20, 300, 60, 25);
+    QLineEdit *formatsLineEdit = new QLineEdit(formats, this);
+    formatsLineEdit->setGeometry(80, 300, 270, 25);
+    formatsLineEdit->setPlaceholderText("json,po,mo,android,ios,bin");
+
     QPushButton *copyToClipboardPushButton = new QPushButton("Copy", this);
     copyToClipboardPushButton->setGeometry(290, 260, 60, 40);
 
@@ -94,33 +193,56 @@ AppWindow::AppWindow(QWidget *parent) : QWidget(parent)
     convertButton->setDisabled(translationFilenameString == nullptr);
     convertButton->setGeometry(420, 260, 200, 60);
 
+    QLabel *detailsLabel = new QLabel("Details:", this);
+    detailsLabel->setGeometry(20, 330, 60, 20);
+    QLineEdit *searchLineEdit = new QLineEdit(this);
+    searchLineEdit->setGeometry(360, 328, 260, 24);
+    searchLineEdit->setPlaceholderText("Search keys and texts, press Enter");
+    detailsTextEdit = new QTextEdit(this);
+    detailsTextEdit->setReadOnly(true);
+    detailsTextEdit->setGeometry(20, 355, 600, 185);
+
     connect(chooseFileButton, &QPushButton::clicked, this, &AppWindow::onChooseTranslationButtonClicked);
     connect(columnNameIndexSpinBox, &QSpinBox::valueChanged, this, &AppWindow::onColumnNameIndexChanged);
     connect(rowNameIndexSpinBox, &QSpinBox::valueChanged, this, &AppWindow::onRowNameIndexChanged);
+    connect(shouldRepairInvalidUtf8CheckBox, &QCheckBox::toggled, this, &AppWindow::onShouldRepairInvalidUtf8Checked);
+    connect(shouldNormalizeNfcCheckBox, &QCheckBox::toggled, this, &AppWindow::onShouldNormalizeNfcChecked);
+    connect(shouldSortKeysCheckBox, &QCheckBox::toggled, this, &AppWindow::onShouldSortKeysChecked);
+    connect(historySizeSpinBox, &QSpinBox::valueChanged, this, &AppWindow::onHistorySizeChanged);
+    connect(formatsLineEdit, &QLineEdit::textChanged, this, &AppWindow::onFormatsChanged);
+    connect(missingTranslationComboBox, &QComboBox::currentIndexChanged, this, &AppWindow::onMissingTranslationChanged);
+    connect(separatorComboBox, &QComboBox::currentIndexChanged, this, &AppWindow::onSeparatorChanged);
     connect(copyToClipboardPushButton, &QPushButton::clicked, this, &AppWindow::onCopyToClipboardButtonClicked);
     connect(convertButton, &QPushButton::clicked, this, &AppWindow::onConvertButtonClicked);
+    connect(searchLineEdit, &QLineEdit::returnPressed, this, [this, searchLineEdit]()
+    {
+        onSearchReturnPressed(searchLineEdit->text());
+    });
 }
 
 void AppWindow::onChooseTranslationButtonClicked()
 {
-    translationFilenameString = QFileDialog::getOpenFileName(this, "Choose translation file", "", "CSV Files (*.csv)");
+    translationFilenameString = QFileDialog::getOpenFileName(this, "Choose translation file", "", "Translation Files (*.csv *.tsv *.xlsx *.ods *.jsonl *.ndjson)");
     if (translationFilenameString != nullptr)
     {
         filenameTextEdit->setText(translationFilenameString);
         convertButton->setDisabled(false);
         settings->setValue("translationFilename", translationFilenameString);
+        translationService.reset();
     }
 }
 
 void AppWindow::onColumnNameIndexChanged(int value)
 {
     columnNameIndex = value;
+    translationService.reset();
     settings->setValue("columnNameIndex", columnNameIndex);
 }
 
 void AppWindow::onRowNameIndexChanged(int value)
 {
     rowNameIndex = value;
+    translationService.reset();
     settings->setValue("rowNameIndex", rowNameIndex);
 }
 
@@ -130,18 +252,130 @@ void AppWindow::onShouldReplaceBreakLinesChecked(bool checked)
     settings->setValue("shouldReplaceBreakLines", shouldReplaceBreakLines);
 }
 
+void AppWindow::onShouldRepairInvalidUtf8Checked(bool checked)
+{
+    shouldRepairInvalidUtf8 = checked;
+    translationService.reset();
+    settings->setValue("shouldRepairInvalidUtf8", shouldRepairInvalidUtf8);
+}
+
+void AppWindow::onShouldNormalizeNfcChecked(bool checked)
+{
+    shouldNormalizeNfc = checked;
+    translationService.reset();
+    settings->setValue("shouldNormalizeNfc", shouldNormalizeNfc);
+}
+
+void AppWindow::onShouldSortKeysChecked(bool checked)
+{
+    shouldSortKeys = checked;
+    translationService.reset();
+    settings->setValue("shouldSortKeys", shouldSortKeys);
+}
+
+void AppWindow::onMissingTranslationChanged(int index)
+{
+    missingTranslation = index;
+    settings->setValue("missingTranslation", missingTranslation);
+}
+
+void AppWindow::onSeparatorChanged(int index)
+{
+    separatorIndex = index;
+    translationService.reset();
+    settings->setValue("separatorIndex", separatorIndex);
+}
+
+void AppWindow::onHistorySizeChanged(int value)
+{
+    historySize = value;
+    settings->setValue("historySize", historySize);
+}
+
+void AppWindow::onFormatsChanged(const QString &text)
+{
+    formats = text;
+    settings->setValue("formats", formats);
+}
+
 void AppWindow::onCopyToClipboardButtonClicked()
 {
     QClipboard *clipboard = QApplication::clipboard();
     clipboard->setText(serialTextEdit->toPlainText());
 }
 
+ConvertOptions AppWindow::makeConvertOptions() const
+{
+    ConvertOptions options;
+    options.translationFilename = translationFilenameString.toStdString();
+    options.columnNameIndex = columnNameIndex;
+    options.rowNameIndex = rowNameIndex;
+    options.shouldReplaceBreakLines = shouldReplaceBreakLines;
+    options.shouldRepairInvalidUtf8 = shouldRepairInvalidUtf8;
+    options.shouldNormalizeNfc = shouldNormalizeNfc;
+    options.shouldSortKeys = shouldSortKeys;
+    options.missingTranslation = static_cast<MissingTranslation>(missingTranslation);
+    static const char separators[] = {',', ';', '\t', '|'};
+    if (separatorIndex > 0 && separatorIndex <= 4)
+    {
+        CsvDialect dialect;
+        dialect.separator = separators[separatorIndex - 1];
+        options.dialect = dialect;
+    }
+    options.formats.clear();
+    std::stringstream formatsStream(formats.toStdString());
+    std::string format;
+    while (std::getline(formatsStream, format, ','))
+    {
+        if (format.size() > 0)
+        {
+            options.formats.push_back(format);
+        }
+    }
+    return options;
+}
+
+void AppWindow::onSearchReturnPressed(const QString &query)
+{
+    static const size_t maxHitCount = 200;
+
+    if (query.isEmpty() || translationFilenameString.isEmpty())
+    {
+        return;
+    }
+
+    try
+    {
+        // Kept between searches, the sheet is parsed again only when the file changed.
+        if (translationService == nullptr)
+        {
+            translationService = std::make_unique<TranslationService>(makeConvertOptions());
+        }
+        translationService->reload();
+
+        const std::vector<SearchHit> hits = translationService->search(query.toStdString(), maxHitCount);
+        QString details = QString("%1 results for \"%2\"\n").arg(hits.size() < maxHitCount ? QString::number(hits.size()) : QString("First %1").arg(maxHitCount)).arg(query);
+        for (auto &&hit : hits)
+        {
+            details += QString("Row %1 %2 %3: %4\n")
+                           .arg(hit.row)
+                           .arg(QString::fromStdString(hit.key))
+                           .arg(hit.langName.empty() ? QString("(key)") : QString::fromStdString(hit.langName))
+                           .arg(QString::fromStdString(hit.text));
+        }
+        detailsTextEdit->setPlainText(details);
+    }
+    catch (const std::exception &e)
+    {
+        QMessageBox::critical(this, "Search Error", e.what(), QMessageBox::StandardButton::Ok);
+    }
+}
+
 void AppWindow::onConvertButtonClicked()
 {
-    const QString outputBaseFolder = "locales";
-    const std::string langNames[] = {"en", "zh"};
     const char *error = nullptr;
     std::stringstream duplicatedKeysMessageStream;
+    ConvertResult result;
 
     QFile f(translationFilenameString);
     if (!f.exists())
@@ -156,38 +390,21 @@ void AppWindow::onConvertButtonClicked()
 
     try
     {
-        QString oldTimestamp = serialTextEdit->toPlainText();
-        if (oldTimestamp.size() > 0)
+        ConvertOptions options = makeConvertOptions();
+        options.serial = timestampStr;
+        options.historySize = static_cast<size_t>(historySize);
+        for (auto &&serial : serialHistory)
         {
-            // Remove old translation files.
-            for (auto &&langName : langNames)
-            {
-                QString filename = outputBaseFolder + "/" + langName.c_str() + "/common" + "-" + oldTimestamp + ".json";
-                QFile::remove(filename);
-            }
+            options.oldSerials.push_back(serial.toStdString());
         }
 
-        rapidcsv::Document doc = readCvs(translationFilenameString.toStdString(), columnNameIndex, rowNameIndex);
-        for (auto &&langName : langNames)
+        result = convertTranslations(options);
+        for (auto &&[langName, duplicatedKeys] : result.duplicatedKeys)
         {
-            // Create output directory if not exists.
-            const QString outputFolder = outputBaseFolder + "/" + langName.c_str();
-            QDir dir;
-            if (!dir.exists(outputFolder))
-            {
-                dir.mkpath(outputFolder);
-            }
-            const QString filename = outputFolder + "/" + "common-" + timestampStr.c_str() + ".json";
-
-            const std::set<std::string> duplicatedKeys = writeJson(doc, langName, filename.toStdString(), shouldReplaceBreakLines);
-
-            if (duplicatedKeys.size() > 0)
+            duplicatedKeysMessageStream << langName << ":\n";
+            for (auto &&key : duplicatedKeys)
             {
-                duplicatedKeysMessageStream << langName << ":\n";
-                for (auto &&key : duplicatedKeys)
-                {
-                    duplicatedKeysMessageStream << "  " << key << "\n";
-                }
+                duplicatedKeysMessageStream << "  " << key << "\n";
             }
         }
     }
@@ -205,6 +422,12 @@ void AppWindow::onConvertButtonClicked()
     {
         serialTextEdit->setText(timestampStr.c_str());
         settings->setValue("lastSerial", timestampStr.c_str());
+        serialHistory.clear();
+        for (auto &&serial : result.serialHistory)
+        {
+            serialHistory.append(QString::fromStdString(serial));
+        }
+        settings->setValue("serialHistory", serialHistory);
 
         QString duplicatedKeysMessage{duplicatedKeysMessageStream.str().c_str()};
         QString message;
@@ -216,6 +439,65 @@ void AppWindow::onConvertButtonClicked()
         {
             message = "Success";
         }
+        if (result.invalidUtf8Keys.size() > 0)
+        {
+            message += "\nRepaired invalid UTF-8 in keys:\n";
+            for (auto &&key : result.invalidUtf8Keys)
+            {
+                message += QString("  ") + key.c_str() + "\n";
+            }
+        }
+
+        const ConvertStats &stats = result.stats;
+        QString details = result.format != SheetFormat::Csv
+                              ? QString("Read as %1\n").arg(QString::fromStdString(sheetFormatName(result.format)))
+                              : QString("Read as %1 separated%2%3\n")
+                                    .arg(QString::fromStdString(separatorName(result.dialect.separator)))
+                                    .arg(result.dialect.quoteChar == '"' ? QString() : QString(", quoted with %1").arg(QChar(result.dialect.quoteChar)))
+                                    .arg(result.dialect.shouldTrim ? ", trimmed" : "");
+        details += QString("%1 rows, %2 cells, %3 KB in, %4 KB out\n")
+                       .arg(stats.rowCount)
+                       .arg(stats.cellCount)
+                       .arg(stats.inputBytes / 1024)
+                       .arg(stats.outputBytes / 1024);
+        for (auto &&localeFile : result.localeFiles)
+        {
+            details += QString("%1 (%2): %3 missing translations, %4 filled from fallback\n")
+                           .arg(QString::fromStdString(localeFile.langName))
+                           .arg(QString::fromStdString(localeFile.format))
+                           .arg(localeFile.missingKeys.size())
+                           .arg(localeFile.filledKeyCount);
+        }
+        for (auto &&stage : stats.stages)
+        {
+            details += QString("%1: %2 ms\n")
+                           .arg(QString::fromStdString(stage.name))
+                           .arg(stage.milliseconds, 0, 'f', 2);
+        }
+        for (auto &&diff : result.localeDiffs)
+        {
+            details += QString("%1: %2 added, %3 changed, %4 removed since the last serial\n")
+                           .arg(QString::fromStdString(diff.langName))
+                           .arg(diff.addedKeys.size())
+                           .arg(diff.changedKeys.size())
+                           .arg(diff.removedKeys.size());
+        }
+        for (auto &&mismatch : result.placeholderMismatches)
+        {
+            details += QString("Placeholder mismatch in %1 at row %2: %3\n")
+                           .arg(QString::fromStdString(mismatch.langName))
+                           .arg(mismatch.row)
+                           .arg(QString::fromStdString(mismatch.key));
+        }
+        details += QString("Total: %1 ms, peak memory %2 MB")
+                       .arg(stats.totalMilliseconds, 0, 'f', 2)
+                       .arg(stats.peakMemoryBytes / (1024.0 * 1024.0), 0, 'f', 1);
+        detailsTextEdit->setPlainText(details);
+
+        if (result.placeholderMismatches.size() > 0)
+        {
+            message += QString("\n%1 translations with mismatched placeholders, see the details.").arg(result.placeholderMismatches.size());
+        }
         QMessageBox::information(this, "Convert Result", message, QMessageBox::StandardButton::Ok);
     }
 }
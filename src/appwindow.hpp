@@ -3,6 +3,8 @@
 
 #include <QWidget>
 #include <QSettings>
+#include <QStringList>
+#include "service.hpp"
 
 class QTextEdit;
 class QString;
@@ -19,18 +21,42 @@ private slots:
     void onColumnNameIndexChanged(int);
     void onRowNameIndexChanged(int);
     void onShouldReplaceBreakLinesChecked(bool);
+    void onShouldRepairInvalidUtf8Checked(bool);
+    void onShouldNormalizeNfcChecked(bool);
+    void onShouldSortKeysChecked(bool);
+    void onMissingTranslationChanged(int);
+    void onSeparatorChanged(int);
+    void onHistorySizeChanged(int);
+    void onFormatsChanged(const QString &);
     void onCopyToClipboardButtonClicked();
     void onConvertButtonClicked();
+    void onSearchReturnPressed(const QString &query);
 
 private:
+    ConvertOptions makeConvertOptions() const;
+
     std::unique_ptr<QSettings> settings;
     QTextEdit *filenameTextEdit;
     QString translationFilenameString;
     QTextEdit *serialTextEdit;
+    // Serials of the locale files on disk, newest first.
+    QStringList serialHistory;
     QPushButton *convertButton;
+    QTextEdit *detailsTextEdit;
     int32_t columnNameIndex;
     int32_t rowNameIndex;
     bool shouldReplaceBreakLines;
+    bool shouldRepairInvalidUtf8;
+    bool shouldNormalizeNfc;
+    bool shouldSortKeys;
+    int32_t missingTranslation;
+    // 0 to sniff the dialect, otherwise the index of the separator in the combo box.
+    int32_t separatorIndex;
+    int32_t historySize;
+    // Comma-separated output formats.
+    QString formats;
+    // Sheet kept parsed for the search box, reset when the reading options change.
+    std::unique_ptr<TranslationService> translationService;
 };
 
 #endif // APP_WINDOW_HPP
@@ -0,0 +1,99 @@
+#include "binarylocale.hpp"
+#include <stdexcept>
+#include <string>
+
+uint64_t binaryLocaleHash(std::string_view key)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+    for (unsigned char c : key)
+    {
+        hash ^= c;
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+uint32_t binaryLocaleSlot(uint64_t hash, uint32_t displacement, uint32_t entryCount)
+{
+    // MurmurHash3 finalizer, so that every displacement gives an unrelated slot.
+    uint64_t x = hash + displacement * 0x9e3779b97f4a7c15;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccd;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53;
+    x ^= x >> 33;
+    return static_cast<uint32_t>(x % entryCount);
+}
+
+BinaryLocale::BinaryLocale(const char *data, size_t size) : data(data)
+{
+    if (size < headerSize || std::string_view(data, 4) != "QPPL")
+    {
+        throw std::runtime_error("not a binary locale file");
+    }
+    if (field(4) != version)
+    {
+        throw std::runtime_error("unsupported binary locale version " + std::to_string(field(4)));
+    }
+
+    entryCount = field(8);
+    bucketCount = field(12);
+    displacementsOffset = field(16);
+    slotsOffset = field(20);
+    stringsOffset = field(24);
+    stringsSize = field(28);
+    if ((entryCount > 0 && bucketCount == 0) ||
+        displacementsOffset + uint64_t(bucketCount) * 4 > size ||
+        slotsOffset + uint64_t(entryCount) * 16 > size ||
+        stringsOffset + uint64_t(stringsSize) > size)
+    {
+        throw std::runtime_error("truncated binary locale file");
+    }
+}
+
+std::optional<std::string_view> BinaryLocale::find(std::string_view key) const
+{
+    if (entryCount == 0)
+    {
+        return std::nullopt;
+    }
+
+    const uint64_t hash = binaryLocaleHash(key);
+    const uint32_t displacement = field(displacementsOffset + (hash % bucketCount) * 4);
+    const uint32_t slotIdx = binaryLocaleSlot(hash, displacement, entryCount);
+    // Keys that are not in the file land on an arbitrary slot.
+    if (string(slotIdx, 0) != key)
+    {
+        return std::nullopt;
+    }
+    return string(slotIdx, 1);
+}
+
+std::string_view BinaryLocale::keyAt(size_t i) const
+{
+    return string(i, 0);
+}
+
+std::string_view BinaryLocale::textAt(size_t i) const
+{
+    return string(i, 1);
+}
+
+uint32_t BinaryLocale::field(size_t offset) const
+{
+    // Assembled byte by byte: the data may be unaligned and the host big-endian.
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data + offset);
+    return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+}
+
+std::string_view BinaryLocale::string(size_t slotIdx, size_t fieldIdx) const
+{
+    const size_t slotOffset = slotsOffset + slotIdx * 16 + fieldIdx * 8;
+    const uint32_t offset = field(slotOffset);
+    const uint32_t length = field(slotOffset + 4);
+    if (uint64_t(offset) + length >= stringsSize)
+    {
+        throw std::runtime_error("corrupt binary locale file");
+    }
+    return std::string_view(data + stringsOffset + offset, length);
+}
@@ -0,0 +1,79 @@
+#ifndef BINARY_LOCALE_HPP
+#define BINARY_LOCALE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// Binary locale file (common-<serial>.bin), little-endian 32-bit fields:
+//
+//   header        "QPPL", version, entry count n, bucket count b,
+//                 displacements offset, slots offset, strings offset, strings size
+//   displacements b values, one per bucket
+//   slots         n x {key offset, key length, text offset, text length} into the strings
+//   strings       UTF-8 keys and texts, each followed by a NUL
+//
+// The keys are placed with a minimal perfect hash (hash and displace): a key goes to bucket
+// hash % b, and to slot binaryLocaleSlot(hash, displacement of its bucket, n). A lookup is two
+// hashes, one key comparison and no parsing, so the file can be used straight from an mmap or
+// an ArrayBuffer.
+//
+// This file and binarylocale.cpp only depend on the standard library so clients can copy them.
+
+/**
+ * 64-bit FNV-1a hash of a key.
+ */
+uint64_t binaryLocaleHash(std::string_view key);
+
+/**
+ * Slot of a key hash with the displacement of its bucket.
+ */
+uint32_t binaryLocaleSlot(uint64_t hash, uint32_t displacement, uint32_t entryCount);
+
+/**
+ * Read-only view of a binary locale file in memory.
+ */
+class BinaryLocale
+{
+public:
+    static constexpr uint32_t version = 1;
+    static constexpr size_t headerSize = 32;
+
+    /**
+     * Check the header and the table bounds, the data is not copied and must outlive the view.
+     *
+     * Throws std::runtime_error when the data is not a binary locale file.
+     */
+    BinaryLocale(const char *data, size_t size);
+
+    size_t size() const
+    {
+        return entryCount;
+    }
+
+    /**
+     * Text of a key, or nothing when the key is not in the file. The text is NUL-terminated.
+     */
+    std::optional<std::string_view> find(std::string_view key) const;
+
+    /**
+     * Key and text of the slot i < size(), in hash order.
+     */
+    std::string_view keyAt(size_t i) const;
+    std::string_view textAt(size_t i) const;
+
+private:
+    uint32_t field(size_t offset) const;
+    std::string_view string(size_t slotIdx, size_t fieldIdx) const;
+
+    const char *data;
+    uint32_t entryCount;
+    uint32_t bucketCount;
+    uint32_t displacementsOffset;
+    uint32_t slotsOffset;
+    uint32_t stringsOffset;
+    uint32_t stringsSize;
+};
+
+#endif // BINARY_LOCALE_HPP
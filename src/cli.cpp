@@ -0,0 +1,387 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "convert.hpp"
+#include "daemon.hpp"
+#include "service.hpp"
+
+static void printUsage()
+{
+    std::cerr << "Usage: qpp-console-lang-converter-cli [options] <translation file>\n"
+                 "       qpp-console-lang-converter-cli --import LANG=FILE... [options] <translation file>\n"
+                 "       qpp-console-lang-converter-cli --diff <old locale file> <new locale file>\n"
+                 "       qpp-console-lang-converter-cli --daemon PORT [options] <translation file>\n"
+                 "       qpp-console-lang-converter-cli --search TEXT [options] <translation file>\n"
+                 "  --output FOLDER               output base folder (default locales)\n"
+                 "  --languages en,zh             language columns to convert (default en,zh)\n"
+                 "  --column-name-index N         row of the column names (default 1)\n"
+                 "  --row-name-index N            column of the keys (default 1)\n"
+                 "  --separator comma|semicolon|tab|pipe|C  cell separator (default detected from the file start)\n"
+                 "  --quote C                     quote character (default detected, usually \")\n"
+                 "  --trim                        trim the spaces around the cells\n"
+                 "  --keep-break-lines            keep the literal \\n sequences of the cells\n"
+                 "  --reject-invalid-utf8         fail instead of repairing invalid UTF-8\n"
+                 "  --normalize-nfc               normalize the cells to NFC\n"
+                 "  --serial SERIAL               serial of the written files (default current time)\n"
+                 "  --old-serial SERIAL           serial of previous files, repeat newest first\n"
+                 "  --history N                   previous versions to keep with a delta bundle, needs json (default 0)\n"
+                 "  --formats json,po,mo,android,ios,bin  output formats (default json)\n"
+                 "  --sort-keys                   write the keys in byte order instead of sheet order\n"
+                 "  --missing keep|omit|fallback  what to write for empty translations (default keep)\n"
+                 "  --fallback en,zh              fallback languages of --missing fallback (default en)\n"
+                 "  --max-missing RATIO           fail above this share of missing translations (default 1)\n"
+                 "  --source LANG                 source language of the placeholder check and pseudo-locale (default en)\n"
+                 "  --pseudo-locale NAME          also write a pseudo-locale NAME, e.g. en-XA, from the source language\n"
+                 "  --scan FOLDER                 list the keys not used by the sources in FOLDER in the report, repeatable\n"
+                 "  --strip-unused                leave the keys unused by the --scan folders out of the locale files\n"
+                 "  --import LANG=FILE            update the LANG column from a locale file instead of converting\n"
+                 "  --import-output FILE          CSV written by --import (default the translation file, required if not CSV)\n"
+                 "  --report FILE                 JSON report of the conversion, relative to the folder holding --output (default conversion-report.json)\n"
+                 "  --daemon PORT                 serve /render/LANG[/FORMAT], /lookup/KEY and /export/NAMESPACE/LANG\n"
+                 "                                on 127.0.0.1, parsing the translation file again when it changes\n"
+                 "  --search TEXT                 list the keys and cells containing TEXT, ignoring ASCII case\n"
+                 "  --max-hits N                  hits listed by --search (default 100)\n";
+}
+
+static std::vector<std::string> splitList(const std::string &list)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        if (item.size() > 0)
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+int main(int argc, char **argv)
+{
+    ConvertOptions options;
+    ImportOptions importOptions;
+    int daemonPort = -1;
+    std::string searchQuery;
+    size_t maxHitCount = 100;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--help")
+        {
+            printUsage();
+            return 0;
+        }
+        else if (arg == "--diff" && i + 2 < argc)
+        {
+            try
+            {
+                const LocaleDiff diff = diffLocales(readLocaleFile(argv[i + 1]), readLocaleFile(argv[i + 2]));
+                std::cout << diffToJson(diff) << "\n";
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << e.what() << '\n';
+                return 1;
+            }
+            return 0;
+        }
+        else if (arg == "--keep-break-lines")
+        {
+            options.shouldReplaceBreakLines = false;
+        }
+        else if (arg == "--reject-invalid-utf8")
+        {
+            options.shouldRepairInvalidUtf8 = false;
+        }
+        else if (arg == "--normalize-nfc")
+        {
+            options.shouldNormalizeNfc = true;
+        }
+        else if (arg == "--sort-keys")
+        {
+            options.shouldSortKeys = true;
+        }
+        else if (arg == "--separator" && hasValue)
+        {
+            const char separator = parseSeparator(argv[++i]);
+            if (separator == 0)
+            {
+                printUsage();
+                return 1;
+            }
+            options.dialect = options.dialect.value_or(CsvDialect());
+            options.dialect->separator = separator;
+        }
+        else if (arg == "--quote" && hasValue)
+        {
+            const std::string quote = argv[++i];
+            if (quote.size() != 1)
+            {
+                printUsage();
+                return 1;
+            }
+            options.dialect = options.dialect.value_or(CsvDialect());
+            options.dialect->quoteChar = quote[0];
+        }
+        else if (arg == "--trim")
+        {
+            options.dialect = options.dialect.value_or(CsvDialect());
+            options.dialect->shouldTrim = true;
+        }
+        else if (arg == "--output" && hasValue)
+        {
+            options.outputBaseFolder = argv[++i];
+        }
+        else if (arg == "--languages" && hasValue)
+        {
+            options.langNames = splitList(argv[++i]);
+        }
+        else if (arg == "--column-name-index" && hasValue)
+        {
+            options.columnNameIndex = std::atoi(argv[++i]);
+        }
+        else if (arg == "--row-name-index" && hasValue)
+        {
+            options.rowNameIndex = std::atoi(argv[++i]);
+        }
+        else if (arg == "--serial" && hasValue)
+        {
+            options.serial = argv[++i];
+        }
+        else if (arg == "--old-serial" && hasValue)
+        {
+            options.oldSerials.push_back(argv[++i]);
+        }
+        else if (arg == "--history" && hasValue)
+        {
+            options.historySize = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+        }
+        else if (arg == "--missing" && hasValue)
+        {
+            const std::string mode = argv[++i];
+            if (mode == "keep")
+            {
+                options.missingTranslation = MissingTranslation::Keep;
+            }
+            else if (mode == "omit")
+            {
+                options.missingTranslation = MissingTranslation::Omit;
+            }
+            else if (mode == "fallback")
+            {
+                options.missingTranslation = MissingTranslation::Fallback;
+            }
+            else
+            {
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--formats" && hasValue)
+        {
+            options.formats = splitList(argv[++i]);
+        }
+        else if (arg == "--fallback" && hasValue)
+        {
+            options.fallbackLangNames = splitList(argv[++i]);
+        }
+        else if (arg == "--max-missing" && hasValue)
+        {
+            options.maxMissingRatio = std::atof(argv[++i]);
+        }
+        else if (arg == "--source" && hasValue)
+        {
+            options.sourceLangName = argv[++i];
+        }
+        else if (arg == "--pseudo-locale" && hasValue)
+        {
+            options.pseudoLangName = argv[++i];
+        }
+        else if (arg == "--scan" && hasValue)
+        {
+            options.sourceFolders.push_back(argv[++i]);
+        }
+        else if (arg == "--strip-unused")
+        {
+            options.shouldStripUnusedKeys = true;
+        }
+        else if (arg == "--import" && hasValue)
+        {
+            const std::string value = argv[++i];
+            const size_t separatorPos = value.find('=');
+            if (separatorPos == std::string::npos)
+            {
+                printUsage();
+                return 1;
+            }
+            importOptions.localeFilenames[value.substr(0, separatorPos)] = value.substr(separatorPos + 1);
+        }
+        else if (arg == "--import-output" && hasValue)
+        {
+            importOptions.outputFilename = argv[++i];
+        }
+        else if (arg == "--daemon" && hasValue)
+        {
+            daemonPort = std::atoi(argv[++i]);
+        }
+        else if (arg == "--search" && hasValue)
+        {
+            searchQuery = argv[++i];
+        }
+        else if (arg == "--max-hits" && hasValue)
+        {
+            maxHitCount = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+        }
+        else if (arg == "--report" && hasValue)
+        {
+            options.reportFilename = argv[++i];
+        }
+        else if (arg.rfind("--", 0) != 0 && options.translationFilename.empty())
+        {
+            options.translationFilename = arg;
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (options.translationFilename.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    if (daemonPort >= 0)
+    {
+        if (daemonPort > 65535)
+        {
+            printUsage();
+            return 1;
+        }
+        return runDaemon(argc, argv, options, static_cast<uint16_t>(daemonPort));
+    }
+
+    if (searchQuery.size() > 0)
+    {
+        try
+        {
+            TranslationService service(options);
+            service.reload();
+            std::cout << searchHitsToJson(service.search(searchQuery, maxHitCount)) << "\n";
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+        return 0;
+    }
+
+    if (importOptions.localeFilenames.size() > 0)
+    {
+        importOptions.translationFilename = options.translationFilename;
+        importOptions.columnNameIndex = options.columnNameIndex;
+        importOptions.rowNameIndex = options.rowNameIndex;
+        importOptions.dialect = options.dialect;
+        importOptions.shouldReplaceBreakLines = options.shouldReplaceBreakLines;
+        importOptions.missingTranslation = options.missingTranslation;
+        importOptions.fallbackLangNames = options.fallbackLangNames;
+        importOptions.pseudoLangName = options.pseudoLangName;
+        try
+        {
+            const ImportResult importResult = importTranslations(importOptions);
+            for (auto &&[langName, updatedCellCount] : importResult.updatedCellCounts)
+            {
+                std::cerr << langName << ": " << updatedCellCount << " cells updated\n";
+            }
+            for (auto &&[langName, unknownKeys] : importResult.unknownKeys)
+            {
+                for (auto &&key : unknownKeys)
+                {
+                    std::cerr << langName << ": unknown key " << key << "\n";
+                }
+            }
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+        return 0;
+    }
+
+    if (options.serial.empty())
+    {
+        // Generate new timestamp.
+        int64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        options.serial = std::to_string(timestamp);
+    }
+
+    ConvertResult result;
+    try
+    {
+        result = convertTranslations(options);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    for (auto &&[langName, duplicatedKeys] : result.duplicatedKeys)
+    {
+        std::cerr << "Duplicated keys in " << langName << ":\n";
+        for (auto &&key : duplicatedKeys)
+        {
+            std::cerr << "  " << key << "\n";
+        }
+    }
+    if (result.invalidUtf8Keys.size() > 0)
+    {
+        std::cerr << "Repaired invalid UTF-8 in keys:\n";
+        for (auto &&key : result.invalidUtf8Keys)
+        {
+            std::cerr << "  " << key << "\n";
+        }
+    }
+
+    if (options.sourceFolders.size() > 0)
+    {
+        std::cerr << result.unusedKeys.size() << " unused keys" << (options.shouldStripUnusedKeys ? " left out" : "") << "\n";
+    }
+
+    if (options.oldSerials.size() > 0 && std::find(options.formats.begin(), options.formats.end(), "json") == options.formats.end())
+    {
+        std::cerr << "No changes listed: --old-serial compares the json files, which --formats leaves out\n";
+    }
+    for (auto &&diff : result.localeDiffs)
+    {
+        std::cerr << "Changes in " << diff.langName << ": " << diff.addedKeys.size() << " added, "
+                  << diff.changedKeys.size() << " changed, " << diff.removedKeys.size() << " removed\n";
+    }
+    for (auto &&mismatch : result.placeholderMismatches)
+    {
+        std::cerr << "Placeholder mismatch in " << mismatch.langName << " at row " << mismatch.row << ": " << mismatch.key << "\n";
+    }
+
+    std::cerr << "Serial history:";
+    for (auto &&serial : result.serialHistory)
+    {
+        std::cerr << " " << serial;
+    }
+    std::cerr << "\n";
+
+    std::cout << reportToJson(options, result);
+
+    return 0;
+}
@@ -1,72 +1,1002 @@
+#include "convert.hpp"
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <future>
+#include <optional>
+#include <iterator>
 #include <filesystem>
 #include <set>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <QCryptographicHash>
 #include "rapidcsv.h"
+#include "filereader.hpp"
+#include "json.hpp"
+#include "keyusage.hpp"
+#include "placeholders.hpp"
+#include "pseudolocale.hpp"
+#include "sheetreader.hpp"
+#include "utf8.hpp"
 
-rapidcsv::Document readCvs(const std::string &filename, int columnNameIndex = 1, int rowNameIndex = 1)
+/**
+ * Load a translation file of any format, see sheetFormatOf().
+ *
+ * @return The dialect a CSV or TSV file was parsed with, the default one for other formats.
+ */
+static CsvDialect loadSheet(rapidcsv::Document &doc, const std::string &filename, std::vector<char> &&data, int columnNameIndex, int rowNameIndex, const std::optional<CsvDialect> &dialect)
+{
+    const SheetFormat format = sheetFormatOf(filename);
+    if (format != SheetFormat::Csv && format != SheetFormat::Tsv)
+    {
+        const std::vector<char> sheetData = std::move(data);
+        const std::unique_ptr<SheetReader> reader = makeSheetReader(format, std::string_view(sheetData.data(), sheetData.size()), columnNameIndex, rowNameIndex);
+        doc.LoadRows([&](std::vector<std::string> &cells)
+        {
+            return reader->readRow(cells);
+        }, rapidcsv::LabelParams(columnNameIndex, rowNameIndex));
+        if (doc.GetColumnCount() == 0)
+        {
+            throw std::runtime_error("no language columns in the " + sheetFormatName(format) + " file");
+        }
+        return CsvDialect();
+    }
+
+    // A TSV file is taken as separated by tabs and quoted with double quotes, unless told otherwise.
+    CsvDialect usedDialect;
+    if (dialect)
+    {
+        usedDialect = *dialect;
+    }
+    else if (format == SheetFormat::Tsv)
+    {
+        usedDialect.separator = '\t';
+    }
+    else
+    {
+        usedDialect = sniffDialect(std::string_view(data.data(), data.size()));
+    }
+    doc.Load(std::move(data), rapidcsv::LabelParams(columnNameIndex, rowNameIndex),
+             rapidcsv::SeparatorParams(usedDialect.separator, usedDialect.shouldTrim, false, true, true, usedDialect.quoteChar));
+    if (doc.GetColumnCount() == 0)
+    {
+        // Usually split at the wrong separator, which leaves no column after the keys.
+        throw std::runtime_error("no language columns when separated by " + separatorName(usedDialect.separator));
+    }
+    return usedDialect;
+}
+
+rapidcsv::Document readCvs(const std::string &filename, int columnNameIndex, int rowNameIndex, const std::optional<CsvDialect> &dialect)
 {
-    std::filesystem::path path = filename;
-    std::ifstream file(path);
-    rapidcsv::Document doc(file, rapidcsv::LabelParams(columnNameIndex, rowNameIndex), rapidcsv::SeparatorParams(',', false, false, true, true));
-    file.close();
+    rapidcsv::Document doc;
+    loadSheet(doc, filename, readFile(filename), columnNameIndex, rowNameIndex, dialect);
     return doc;
 }
 
+/**
+ * Validate the UTF-8 of the keys and of the given translation columns.
+ *
+ * Ill-formed sequences are replaced with U+FFFD when shouldRepair is set, otherwise a
+ * std::runtime_error naming the offending keys is thrown. With shouldNormalize the cells are
+ * also normalized to NFC.
+ *
+ * @return Keys whose key or cells contained invalid UTF-8.
+ */
+std::set<std::string> sanitizeUtf8(rapidcsv::Document &doc, const std::vector<std::string> &columnNames, bool shouldRepair, bool shouldNormalize)
+{
+    std::set<std::string> invalidKeys;
+    const std::vector<std::string> rowNames = doc.GetRowNames();
+    for (size_t i = 0; i < rowNames.size(); i++)
+    {
+        if (!isValidUtf8(rowNames[i]))
+        {
+            const std::string key = repairUtf8(rowNames[i]);
+            invalidKeys.insert(key);
+            if (shouldRepair)
+            {
+                doc.SetRowName(i, key);
+            }
+        }
+    }
+
+    for (auto &&columnName : columnNames)
+    {
+        const int columnIdx = doc.GetColumnIdx(columnName);
+        if (columnIdx < 0)
+        {
+            throw std::out_of_range("column not found: " + columnName);
+        }
+
+        // Views into the document, so clean cells are checked without being copied.
+        const std::vector<std::string_view> cells = doc.GetColumn<std::string_view>(static_cast<size_t>(columnIdx));
+        for (size_t i = 0; i < cells.size(); i++)
+        {
+            std::string text;
+            if (!isValidUtf8(cells[i]))
+            {
+                invalidKeys.insert(repairUtf8(rowNames[i]));
+                if (!shouldRepair)
+                {
+                    continue;
+                }
+                text = repairUtf8(cells[i]);
+            }
+            else if (shouldNormalize && !isNfcQuick(cells[i]))
+            {
+                text = cells[i];
+            }
+            else
+            {
+                continue;
+            }
+
+            if (shouldNormalize && !isNfcQuick(text))
+            {
+                text = normalizeNfc(text);
+            }
+            doc.SetCell<std::string>(static_cast<size_t>(columnIdx), i, text);
+        }
+    }
+
+    if (!shouldRepair && invalidKeys.size() > 0)
+    {
+        std::string message = "Invalid UTF-8 in keys:";
+        for (auto &&key : invalidKeys)
+        {
+            message += "\n  " + key;
+        }
+        throw std::runtime_error(message);
+    }
+
+    return invalidKeys;
+}
+
+KeyIndex indexKeys(const rapidcsv::Document &doc)
+{
+    KeyIndex keyIndex;
+    std::unordered_map<std::string, size_t> keyPositions;
+    const std::vector<std::string> rowNames = doc.GetRowNames();
+    keyPositions.reserve(rowNames.size());
+    for (size_t i = 0; i < rowNames.size(); i++)
+    {
+        const auto [it, isInserted] = keyPositions.emplace(rowNames[i], keyIndex.keys.size());
+        if (isInserted)
+        {
+            keyIndex.keys.push_back(rowNames[i]);
+            keyIndex.rowIndices.push_back(i);
+        }
+        else
+        {
+            // Key already exists, a lookup by name resolves to its last row.
+            keyIndex.duplicatedKeys.insert(rowNames[i]);
+            std::vector<size_t> &rows = keyIndex.duplicatedKeyRows[rowNames[i]];
+            if (rows.empty())
+            {
+                rows.push_back(keyIndex.rowIndices[it->second]);
+            }
+            rows.push_back(i);
+            keyIndex.rowIndices[it->second] = i;
+        }
+    }
+    return keyIndex;
+}
+
+void sortKeys(KeyIndex &keyIndex)
+{
+    static const size_t chunkMinSize = 16 * 1024;
+
+    struct SortEntry
+    {
+        std::string_view key;
+        size_t position;
+    };
+    std::vector<SortEntry> entries(keyIndex.keys.size());
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        entries[i] = {keyIndex.keys[i], i};
+    }
+    const auto isLess = [](const SortEntry &a, const SortEntry &b)
+    {
+        return a.key < b.key;
+    };
+
+    // Sort chunks on their own threads, then merge neighbouring chunks pairwise.
+    const size_t threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    const size_t chunkCount = std::max<size_t>(std::min(threadCount, entries.size() / chunkMinSize), 1);
+    std::vector<size_t> bounds;
+    for (size_t i = 0; i <= chunkCount; i++)
+    {
+        bounds.push_back(entries.size() * i / chunkCount);
+    }
+    for (size_t width = 1;; width *= 2)
+    {
+        std::vector<std::future<void>> futures;
+        for (size_t i = 0; i < chunkCount; i += width * 2)
+        {
+            const auto first = entries.begin() + bounds[i];
+            const auto middle = entries.begin() + bounds[std::min(i + width, chunkCount)];
+            const auto last = entries.begin() + bounds[std::min(i + width * 2, chunkCount)];
+            futures.push_back(std::async(std::launch::async, [=]()
+            {
+                if (width == 1)
+                {
+                    std::sort(first, middle, isLess);
+                    std::sort(middle, last, isLess);
+                }
+                std::inplace_merge(first, middle, last, isLess);
+            }));
+        }
+        for (auto &&future : futures)
+        {
+            future.get();
+        }
+        if (width * 2 >= chunkCount)
+        {
+            break;
+        }
+    }
+
+    KeyIndex sorted;
+    sorted.keys.reserve(entries.size());
+    sorted.rowIndices.reserve(entries.size());
+    for (auto &&entry : entries)
+    {
+        sorted.keys.push_back(std::move(keyIndex.keys[entry.position]));
+        sorted.rowIndices.push_back(keyIndex.rowIndices[entry.position]);
+    }
+    keyIndex.keys = std::move(sorted.keys);
+    keyIndex.rowIndices = std::move(sorted.rowIndices);
+}
+
+static size_t findColumn(const rapidcsv::Document &doc, const std::string &columnName)
+{
+    const int columnIdx = doc.GetColumnIdx(columnName);
+    if (columnIdx < 0)
+    {
+        throw std::out_of_range("column not found: " + columnName);
+    }
+    return static_cast<size_t>(columnIdx);
+}
+
+std::vector<PlaceholderMismatch> checkPlaceholders(const rapidcsv::Document &doc, const KeyIndex &keyIndex, const std::string &sourceLangName, const std::vector<std::string> &langNames)
+{
+    const size_t sourceColumnIdx = findColumn(doc, sourceLangName);
+    std::vector<Placeholders> sourcePlaceholders(keyIndex.keys.size());
+    for (size_t i = 0; i < keyIndex.keys.size(); i++)
+    {
+        sourcePlaceholders[i] = extractPlaceholders(doc.GetCell<std::string_view>(sourceColumnIdx, keyIndex.rowIndices[i]));
+    }
+
+    std::vector<std::future<std::vector<PlaceholderMismatch>>> futures;
+    for (auto &&langName : langNames)
+    {
+        const size_t columnIdx = findColumn(doc, langName);
+        if (columnIdx == sourceColumnIdx)
+        {
+            continue;
+        }
+
+        futures.push_back(std::async(std::launch::async, [&, langName, columnIdx]()
+        {
+            std::vector<PlaceholderMismatch> mismatches;
+            for (size_t i = 0; i < keyIndex.keys.size(); i++)
+            {
+                const size_t rowIdx = keyIndex.rowIndices[i];
+                const std::string_view cell = doc.GetCell<std::string_view>(columnIdx, rowIdx);
+                if (cell.empty() || doc.GetCell<std::string_view>(sourceColumnIdx, rowIdx).empty())
+                {
+                    continue;
+                }
+
+                Placeholders placeholders = extractPlaceholders(cell);
+                if (placeholders.names != sourcePlaceholders[i].names || placeholders.isMalformed != sourcePlaceholders[i].isMalformed)
+                {
+                    PlaceholderMismatch mismatch;
+                    mismatch.langName = langName;
+                    mismatch.key = keyIndex.keys[i];
+                    mismatch.row = rowIdx;
+                    mismatch.sourcePlaceholders = sourcePlaceholders[i].names;
+                    mismatch.placeholders = std::move(placeholders.names);
+                    mismatch.isMalformed = placeholders.isMalformed;
+                    mismatches.push_back(std::move(mismatch));
+                }
+            }
+            return mismatches;
+        }));
+    }
+
+    std::vector<PlaceholderMismatch> mismatches;
+    for (auto &&future : futures)
+    {
+        std::vector<PlaceholderMismatch> langMismatches = future.get();
+        std::move(langMismatches.begin(), langMismatches.end(), std::back_inserter(mismatches));
+    }
+    return mismatches;
+}
+
+std::vector<LocaleEntry> collectEntries(const rapidcsv::Document &doc, const KeyIndex &keyIndex, const std::string &columnName,
+                                        MissingTranslation missingTranslation, const std::vector<std::string> &fallbackLangNames, LocaleFile &coverage)
+{
+    const size_t columnIdx = findColumn(doc, columnName);
+    std::vector<size_t> fallbackColumnIdxs;
+    if (missingTranslation == MissingTranslation::Fallback)
+    {
+        for (auto &&fallbackLangName : fallbackLangNames)
+        {
+            const size_t fallbackColumnIdx = findColumn(doc, fallbackLangName);
+            if (fallbackColumnIdx != columnIdx)
+            {
+                fallbackColumnIdxs.push_back(fallbackColumnIdx);
+            }
+        }
+    }
+
+    coverage.langName = columnName;
+    std::vector<LocaleEntry> entries;
+    entries.reserve(keyIndex.keys.size());
+    for (size_t i = 0; i < keyIndex.keys.size(); i++)
+    {
+        const size_t rowIdx = keyIndex.rowIndices[i];
+        std::string_view cell = doc.GetCell<std::string_view>(columnIdx, rowIdx);
+        if (cell.empty())
+        {
+            coverage.missingKeys.push_back(keyIndex.keys[i]);
+            if (missingTranslation != MissingTranslation::Keep)
+            {
+                for (size_t fallbackColumnIdx : fallbackColumnIdxs)
+                {
+                    cell = doc.GetCell<std::string_view>(fallbackColumnIdx, rowIdx);
+                    if (!cell.empty())
+                    {
+                        coverage.filledKeyCount++;
+                        break;
+                    }
+                }
+                if (cell.empty())
+                {
+                    // Left out so that i18next falls back to another language.
+                    continue;
+                }
+            }
+        }
+        entries.push_back({keyIndex.keys[i], cell});
+    }
+    return entries;
+}
+
+/**
+ * Pseudo-localized copy of entries, with the texts stored one after another in pseudoTexts.
+ */
+static std::vector<LocaleEntry> pseudoLocalizeEntries(const std::vector<LocaleEntry> &entries, std::string &pseudoTexts)
+{
+    // Accented letters take two bytes, and a third is added.
+    size_t textSize = 0;
+    for (auto &&entry : entries)
+    {
+        textSize += entry.text.size();
+    }
+    pseudoTexts.reserve(textSize * 5 / 2 + entries.size() * 4);
+
+    std::vector<size_t> textEnds;
+    textEnds.reserve(entries.size());
+    for (auto &&entry : entries)
+    {
+        appendPseudoText(entry.text, pseudoTexts);
+        textEnds.push_back(pseudoTexts.size());
+    }
+
+    // Views are taken once the buffer stopped growing.
+    std::vector<LocaleEntry> pseudoEntries;
+    pseudoEntries.reserve(entries.size());
+    size_t textStart = 0;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        pseudoEntries.push_back({entries[i].key, std::string_view(pseudoTexts).substr(textStart, textEnds[i] - textStart)});
+        textStart = textEnds[i];
+    }
+    return pseudoEntries;
+}
+
+/**
+ * Write a locale file at once and hash it.
+ */
+static void saveLocaleFile(const std::string &output, LocaleFile &localeFile)
+{
+    std::ofstream file(std::filesystem::u8path(localeFile.filename), std::ios::binary);
+    file.write(output.data(), static_cast<std::streamsize>(output.size()));
+    if (!file)
+    {
+        throw std::runtime_error("cannot write " + localeFile.filename);
+    }
+
+    localeFile.byteCount = output.size();
+    const QByteArray hash = QCryptographicHash::hash(QByteArrayView(output.data(), static_cast<qsizetype>(output.size())), QCryptographicHash::Sha256);
+    localeFile.sha256 = hash.toHex().toStdString();
+}
+
+LocaleFile writeJson(const rapidcsv::Document &doc, const KeyIndex &keyIndex, const std::string &columnName, const std::string &filename, bool shouldReplaceBreakLines, MissingTranslation missingTranslation, const std::vector<std::string> &fallbackLangNames)
+{
+    LocaleFile localeFile;
+    const std::vector<LocaleEntry> entries = collectEntries(doc, keyIndex, columnName, missingTranslation, fallbackLangNames, localeFile);
+    localeFile.format = "json";
+    localeFile.filename = filename;
+    saveLocaleFile(makeLocaleWriter("json")->write(entries, columnName, shouldReplaceBreakLines), localeFile);
+    return localeFile;
+}
+
 /**
  * Write the tranlsations from rapidcsv::Document to json file.
  *
  * @return Duplicated keys that are only processed at the first appearance.
  */
-std::set<std::string> writeJson(const rapidcsv::Document &doc, const std::string &columnName, const std::string &filename, bool shouldReplaceBreakLines = true)
+std::set<std::string> writeJson(const rapidcsv::Document &doc, const std::string &columnName, const std::string &filename, bool shouldReplaceBreakLines)
 {
-    std::set<std::string> keySet;
-    std::set<std::string> duplicatedKeys;
-    std::ofstream output(filename);
-    output << "{\n";
-    auto rowNames = doc.GetRowNames();
-    for (size_t i = 0; i < rowNames.size(); i++)
+    const KeyIndex keyIndex = indexKeys(doc);
+    writeJson(doc, keyIndex, columnName, filename, shouldReplaceBreakLines);
+    return keyIndex.duplicatedKeys;
+}
+
+/**
+ * Keys and texts of the entries as they are read back from their JSON locale file.
+ */
+static LocaleEntries jsonLocaleEntries(const std::vector<LocaleEntry> &entries, bool shouldReplaceBreakLines)
+{
+    LocaleEntries jsonEntries;
+    jsonEntries.reserve(entries.size());
+    for (auto &&entry : entries)
     {
-        const std::string rowName = rowNames[i];
-        if (keySet.find(rowName) != keySet.end())
+        // Only backslashes change the text between the sheet and the parsed file.
+        if (entry.text.find('\\') == std::string_view::npos)
         {
-            // Key already exists.
-            duplicatedKeys.insert(rowName);
+            jsonEntries.emplace_back(entry.key, entry.text);
         }
         else
         {
-            keySet.emplace(rowName);
-            std::string text = doc.GetCell<std::string>(columnName, rowName);
-            if (shouldReplaceBreakLines)
+            jsonEntries.emplace_back(entry.key, unquoteJson("\"" + exportJsonText(entry.text, shouldReplaceBreakLines) + "\""));
+        }
+    }
+    return jsonEntries;
+}
+
+/**
+ * Compare the entries of a new locale file with the old versions of its language, read from
+ * disk. The first historySize old versions get a delta bundle to the new one, listed in
+ * index.json next to them.
+ *
+ * @return Diff against the newest old version, unless it is missing or not valid JSON.
+ */
+static std::optional<LocaleDiff> diffHistory(const LocaleFile &localeFile, const LocaleEntries &newEntries, const std::filesystem::path &outputFolder,
+                                             const std::string &serial, const std::vector<std::string> &oldSerials, size_t historySize)
+{
+    // Deltas to the previous serials are outdated.
+    std::error_code error;
+    for (auto &&entry : std::filesystem::directory_iterator(outputFolder, error))
+    {
+        const std::string filename = entry.path().filename().u8string();
+        if (filename.rfind("delta-", 0) == 0 && entry.path().extension() == ".json")
+        {
+            std::filesystem::remove(entry.path(), error);
+        }
+    }
+
+    std::optional<LocaleDiff> newestDiff;
+    std::string deltas;
+    for (size_t i = 0; i < oldSerials.size() && (i == 0 || i < historySize); i++)
+    {
+        LocaleDiff diff;
+        try
+        {
+            diff = diffLocales(readLocaleFile((outputFolder / ("common-" + oldSerials[i] + ".json")).u8string()), newEntries);
+        }
+        catch (const std::runtime_error &)
+        {
+            // A missing or unreadable old file gives no baseline to compare with.
+            continue;
+        }
+        diff.langName = localeFile.langName;
+
+        if (i < historySize)
+        {
+            const std::string deltaFilename = "delta-" + oldSerials[i] + "-" + serial + ".json";
+            const std::string delta = deltaToJson(oldSerials[i], serial, diff, newEntries);
+            std::ofstream file(outputFolder / deltaFilename, std::ios::binary);
+            file.write(delta.data(), static_cast<std::streamsize>(delta.size()));
+            if (!file)
             {
-                // Replace '\n'
-                int pos;
-                while ((pos = text.find("\\n")) != std::string::npos)
+                throw std::runtime_error("cannot write " + (outputFolder / deltaFilename).u8string());
+            }
+            deltas += deltas.empty() ? "\n    " : ",\n    ";
+            deltas += quoteJson(oldSerials[i]) + ": " + quoteJson(deltaFilename);
+        }
+        if (i == 0)
+        {
+            newestDiff = std::move(diff);
+        }
+    }
+
+    if (historySize > 0)
+    {
+        std::string index = "{\n";
+        index += "  \"latest\": " + quoteJson(serial) + ",\n";
+        index += "  \"file\": " + quoteJson("common-" + serial + ".json") + ",\n";
+        index += "  \"deltas\": {" + deltas + (deltas.empty() ? "}\n" : "\n  }\n");
+        index += "}\n";
+        std::ofstream file(outputFolder / "index.json", std::ios::binary);
+        file.write(index.data(), static_cast<std::streamsize>(index.size()));
+        if (!file)
+        {
+            throw std::runtime_error("cannot write " + (outputFolder / "index.json").u8string());
+        }
+    }
+    else
+    {
+        std::filesystem::remove(outputFolder / "index.json", error);
+    }
+
+    return newestDiff;
+}
+
+ConvertResult convertTranslations(const ConvertOptions &options)
+{
+    // Delta bundles patch the JSON files and are made from them, so fail before writing anything.
+    const bool isJsonWritten = std::find(options.formats.begin(), options.formats.end(), "json") != options.formats.end();
+    if (options.historySize > 0 && !isJsonWritten)
+    {
+        throw std::invalid_argument("the delta history needs the json output format");
+    }
+
+    ConvertResult result;
+    ConvertStats &stats = result.stats;
+    const size_t allocationsBefore = allocationCount();
+    const auto start = std::chrono::steady_clock::now();
+    const std::filesystem::path outputBaseFolder = std::filesystem::u8path(options.outputBaseFolder);
+
+    std::vector<char> data;
+    measureStage(stats, "read", [&]()
+    {
+        data = readFile(options.translationFilename);
+    });
+    stats.inputBytes = data.size();
+
+    rapidcsv::Document doc;
+    result.format = sheetFormatOf(options.translationFilename);
+    measureStage(stats, "parse", [&]()
+    {
+        result.dialect = loadSheet(doc, options.translationFilename, std::move(data), options.columnNameIndex, options.rowNameIndex, options.dialect);
+    });
+    stats.rowCount = doc.GetRowCount();
+    stats.cellCount = stats.rowCount * doc.GetColumnCount();
+
+    measureStage(stats, "validate", [&]()
+    {
+        result.invalidUtf8Keys = sanitizeUtf8(doc, options.langNames, options.shouldRepairInvalidUtf8, options.shouldNormalizeNfc);
+    });
+
+    KeyIndex keyIndex;
+    measureStage(stats, "key index", [&]()
+    {
+        keyIndex = indexKeys(doc);
+    });
+
+    if (options.shouldSortKeys)
+    {
+        measureStage(stats, "sort", [&]()
+        {
+            sortKeys(keyIndex);
+        });
+    }
+
+    if (options.sourceFolders.size() > 0)
+    {
+        measureStage(stats, "usage", [&]()
+        {
+            const std::vector<bool> isUsed = findUsedKeys(keyIndex, options.sourceFolders);
+            KeyIndex usedKeyIndex;
+            for (size_t i = 0; i < keyIndex.keys.size(); i++)
+            {
+                if (!isUsed[i])
                 {
-                    text.replace(pos, 2, "");
+                    result.unusedKeys.push_back(keyIndex.keys[i]);
+                }
+                else if (options.shouldStripUnusedKeys)
+                {
+                    usedKeyIndex.keys.push_back(std::move(keyIndex.keys[i]));
+                    usedKeyIndex.rowIndices.push_back(keyIndex.rowIndices[i]);
                 }
             }
+            if (options.shouldStripUnusedKeys)
+            {
+                keyIndex.keys = std::move(usedKeyIndex.keys);
+                keyIndex.rowIndices = std::move(usedKeyIndex.rowIndices);
+            }
+        });
+    }
 
-            // Replace break line to "\\n"
+    // Document rows start after the column names row.
+    const size_t firstSheetRow = static_cast<size_t>(options.columnNameIndex) + 2;
+
+    if (options.shouldCheckPlaceholders)
+    {
+        measureStage(stats, "placeholders", [&]()
+        {
+            result.placeholderMismatches = checkPlaceholders(doc, keyIndex, options.sourceLangName, options.langNames);
+        });
+        for (auto &&mismatch : result.placeholderMismatches)
+        {
+            mismatch.row += firstSheetRow;
+        }
+    }
+
+    std::vector<std::unique_ptr<LocaleWriter>> writers;
+    for (auto &&format : options.formats)
+    {
+        writers.push_back(makeLocaleWriter(format));
+    }
+
+    // Languages written, the pseudo-locale after the language columns.
+    std::vector<std::string> langNames = options.langNames;
+    if (options.pseudoLangName.size() > 0)
+    {
+        langNames.push_back(options.pseudoLangName);
+    }
+
+    // Entries of each language, collected once and shared by all formats.
+    std::vector<LocaleFile> coverages(langNames.size());
+    std::string pseudoTexts;
+    std::vector<std::vector<LocaleEntry>> entries;
+    measureStage(stats, "write", [&]()
+    {
+        std::vector<std::future<std::vector<LocaleEntry>>> entryFutures;
+        for (size_t i = 0; i < langNames.size(); i++)
+        {
+            // Create output directory if not exists.
+            std::filesystem::create_directories(outputBaseFolder / langNames[i]);
+            entryFutures.push_back(std::async(std::launch::async, [&, i]()
             {
-                int pos;
-                while ((pos = text.find("\n")) != std::string::npos)
+                if (i < options.langNames.size())
                 {
-                    text.replace(pos, 1, "\\n");
+                    return collectEntries(doc, keyIndex, langNames[i], options.missingTranslation, options.fallbackLangNames, coverages[i]);
                 }
+                const std::vector<LocaleEntry> sourceEntries = collectEntries(doc, keyIndex, options.sourceLangName, options.missingTranslation, options.fallbackLangNames, coverages[i]);
+                coverages[i].langName = langNames[i];
+                return pseudoLocalizeEntries(sourceEntries, pseudoTexts);
+            }));
+        }
+        for (auto &&future : entryFutures)
+        {
+            entries.push_back(future.get());
+        }
+
+        // One thread per language and format.
+        std::vector<std::future<LocaleFile>> fileFutures;
+        for (size_t i = 0; i < langNames.size(); i++)
+        {
+            for (size_t j = 0; j < writers.size(); j++)
+            {
+                fileFutures.push_back(std::async(std::launch::async, [&, i, j]()
+                {
+                    LocaleFile localeFile = coverages[i];
+                    localeFile.format = options.formats[j];
+                    localeFile.filename = (outputBaseFolder / langNames[i] / writers[j]->filename(options.serial)).u8string();
+                    saveLocaleFile(writers[j]->write(entries[i], langNames[i], options.shouldReplaceBreakLines), localeFile);
+                    return localeFile;
+                }));
             }
+        }
+        for (auto &&future : fileFutures)
+        {
+            result.localeFiles.push_back(future.get());
+        }
+    });
+
+    for (auto &&localeFile : result.localeFiles)
+    {
+        stats.outputBytes += localeFile.byteCount;
+    }
+    if (keyIndex.duplicatedKeys.size() > 0)
+    {
+        for (auto &&langName : options.langNames)
+        {
+            result.duplicatedKeys[langName] = keyIndex.duplicatedKeys;
+        }
+    }
 
-            // Indent
-            output << "  \"";
-            output << rowName << "\": \"" << text << "\"";
-            if (i != rowNames.size() - 1)
+    std::string coverageError;
+    for (auto &&localeFile : coverages)
+    {
+        const double missingRatio = keyIndex.keys.empty() ? 0 : static_cast<double>(localeFile.missingKeys.size()) / keyIndex.keys.size();
+        if (missingRatio > options.maxMissingRatio)
+        {
+            coverageError += "\n  " + localeFile.langName + ": " + std::to_string(localeFile.missingKeys.size()) + " of " + std::to_string(keyIndex.keys.size());
+        }
+    }
+
+    std::vector<std::string> oldSerials;
+    for (auto &&oldSerial : options.oldSerials)
+    {
+        if (oldSerial.size() > 0 && oldSerial != options.serial)
+        {
+            oldSerials.push_back(oldSerial);
+        }
+    }
+    // Without JSON files there is nothing to compare, and the old files are only removed.
+    if (coverageError.empty() && isJsonWritten && (oldSerials.size() > 0 || options.historySize > 0))
+    {
+        measureStage(stats, "diff", [&]()
+        {
+            for (auto &&localeFile : result.localeFiles)
             {
-                output << ",";
+                if (localeFile.format != "json")
+                {
+                    continue;
+                }
+                const size_t langIndex = std::find(langNames.begin(), langNames.end(), localeFile.langName) - langNames.begin();
+                const LocaleEntries newEntries = jsonLocaleEntries(entries[langIndex], options.shouldReplaceBreakLines);
+                std::optional<LocaleDiff> diff = diffHistory(localeFile, newEntries, outputBaseFolder / localeFile.langName, options.serial, oldSerials,
+                                                             options.historySize);
+                if (diff)
+                {
+                    result.localeDiffs.push_back(std::move(*diff));
+                }
             }
-            output << "\n";
+        });
+    }
+
+    for (auto &&[key, rows] : keyIndex.duplicatedKeyRows)
+    {
+        std::vector<size_t> &sheetRows = result.duplicatedKeyRows[key];
+        for (size_t row : rows)
+        {
+            sheetRows.push_back(row + firstSheetRow);
+        }
+    }
+
+    stats.totalMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats.areAllocationsCounted = areAllocationsCounted();
+    stats.allocations = allocationCount() - allocationsBefore;
+    stats.peakMemoryBytes = peakMemoryBytes();
+
+    if (options.reportFilename.size() > 0)
+    {
+        const std::string report = reportToJson(options, result);
+        // parent_path() of "out/locales/" is "out/locales", hence the normalization.
+        const std::filesystem::path reportPath = (outputBaseFolder / "..").lexically_normal() / std::filesystem::u8path(options.reportFilename);
+        std::ofstream file(reportPath, std::ios::binary);
+        file.write(report.data(), static_cast<std::streamsize>(report.size()));
+        if (!file)
+        {
+            throw std::runtime_error("cannot write " + reportPath.u8string());
+        }
+    }
+
+    if (coverageError.size() > 0)
+    {
+        for (auto &&localeFile : result.localeFiles)
+        {
+            std::error_code error;
+            std::filesystem::remove(std::filesystem::u8path(localeFile.filename), error);
         }
+        throw std::runtime_error("Too many missing translations:" + coverageError);
     }
 
-    output << "}";
+    result.serialHistory.push_back(options.serial);
+    for (size_t i = 0; i < oldSerials.size(); i++)
+    {
+        if (i < options.historySize)
+        {
+            result.serialHistory.push_back(oldSerials[i]);
+            continue;
+        }
+
+        // Remove old translation files.
+        for (auto &&langName : langNames)
+        {
+            for (auto &&writer : writers)
+            {
+                std::error_code error;
+                std::filesystem::remove(outputBaseFolder / langName / writer->filename(oldSerials[i]), error);
+            }
+        }
+    }
+
+    return result;
+}
+
+std::string reportToJson(const ConvertOptions &options, const ConvertResult &result)
+{
+    std::string report = "{\n";
+    report += "  \"serial\": " + quoteJson(options.serial) + ",\n";
+    report += "  \"translationFile\": " + quoteJson(options.translationFilename) + ",\n";
+    report += "  \"translationFormat\": " + quoteJson(sheetFormatName(result.format)) + ",\n";
+    if (result.format == SheetFormat::Csv || result.format == SheetFormat::Tsv)
+    {
+        report += "  \"dialect\": {\"separator\": " + quoteJson(separatorName(result.dialect.separator)) +
+                  ", \"quote\": " + quoteJson(std::string(1, result.dialect.quoteChar)) +
+                  ", \"trim\": " + (result.dialect.shouldTrim ? "true" : "false") + "},\n";
+    }
+    report += "  \"languages\": [";
+    for (size_t i = 0; i < result.localeFiles.size(); i++)
+    {
+        const LocaleFile &localeFile = result.localeFiles[i];
+        report += i > 0 ? ",\n" : "\n";
+        report += "    {\n";
+        report += "      \"name\": " + quoteJson(localeFile.langName) + ",\n";
+        report += "      \"format\": " + quoteJson(localeFile.format) + ",\n";
+        report += "      \"file\": " + quoteJson(localeFile.filename) + ",\n";
+        report += "      \"bytes\": " + std::to_string(localeFile.byteCount) + ",\n";
+        report += "      \"sha256\": " + quoteJson(localeFile.sha256) + ",\n";
+        report += "      \"missingKeys\": " + quoteJsonList(localeFile.missingKeys) + ",\n";
+        report += "      \"filledKeyCount\": " + std::to_string(localeFile.filledKeyCount) + "\n";
+        report += "    }";
+    }
+    report += result.localeFiles.empty() ? "],\n" : "\n  ],\n";
+
+    report += "  \"duplicatedKeys\": [";
+    bool isFirst = true;
+    for (auto &&[key, rows] : result.duplicatedKeyRows)
+    {
+        report += isFirst ? "\n" : ",\n";
+        isFirst = false;
+        report += "    {\"key\": " + quoteJson(key) + ", \"rows\": [";
+        for (size_t i = 0; i < rows.size(); i++)
+        {
+            report += i > 0 ? ", " : "";
+            report += std::to_string(rows[i]);
+        }
+        report += "]}";
+    }
+    report += isFirst ? "],\n" : "\n  ],\n";
+
+    report += "  \"placeholderMismatches\": [";
+    for (size_t i = 0; i < result.placeholderMismatches.size(); i++)
+    {
+        const PlaceholderMismatch &mismatch = result.placeholderMismatches[i];
+        report += i > 0 ? ",\n" : "\n";
+        report += "    {\"language\": " + quoteJson(mismatch.langName) +
+                  ", \"key\": " + quoteJson(mismatch.key) +
+                  ", \"row\": " + std::to_string(mismatch.row) +
+                  ", \"expected\": " + quoteJsonList(mismatch.sourcePlaceholders) +
+                  ", \"found\": " + quoteJsonList(mismatch.placeholders) +
+                  ", \"malformed\": " + (mismatch.isMalformed ? "true" : "false") + "}";
+    }
+    report += result.placeholderMismatches.empty() ? "],\n" : "\n  ],\n";
+
+    report += "  \"changes\": [";
+    for (size_t i = 0; i < result.localeDiffs.size(); i++)
+    {
+        report += i > 0 ? ",\n    " : "\n    ";
+        report += diffToJson(result.localeDiffs[i]);
+    }
+    report += result.localeDiffs.empty() ? "],\n" : "\n  ],\n";
+
+    const std::vector<std::string> invalidUtf8Keys(result.invalidUtf8Keys.begin(), result.invalidUtf8Keys.end());
+    report += "  \"invalidUtf8Keys\": " + quoteJsonList(invalidUtf8Keys) + ",\n";
+    report += "  \"unusedKeys\": " + quoteJsonList(result.unusedKeys) + ",\n";
+    report += "  \"unusedKeysStripped\": " + std::string(options.shouldStripUnusedKeys && options.sourceFolders.size() > 0 ? "true" : "false") + ",\n";
+
+    // Nest the stats object one level deeper.
+    report += "  \"stats\": ";
+    for (char c : statsToJson(result.stats))
+    {
+        report += c;
+        if (c == '\n')
+        {
+            report += "  ";
+        }
+    }
+    report += "\n}\n";
+    return report;
+}
+
+/**
+ * Whether the JSON locale file text was converted from the cell.
+ */
+static bool isConvertedText(std::string_view cell, const std::string &text, bool shouldReplaceBreakLines)
+{
+    if (cell == text)
+    {
+        return true;
+    }
+    try
+    {
+        return unquoteJson("\"" + exportJsonText(cell, shouldReplaceBreakLines) + "\"") == text;
+    }
+    catch (const std::runtime_error &)
+    {
+        // The cell did not convert to valid JSON, so the text is a correction.
+        return false;
+    }
+}
+
+ImportResult importTranslations(const ImportOptions &options)
+{
+    if (options.pseudoLangName.size() > 0 && options.localeFilenames.count(options.pseudoLangName) > 0)
+    {
+        throw std::invalid_argument("cannot import the pseudo-locale " + options.pseudoLangName + ", it is generated from the source language");
+    }
+
+    ImportResult result;
+    rapidcsv::Document doc;
+    // Only the files read by rapidcsv can be saved.
+    const auto isWritable = [](SheetFormat format)
+    {
+        return format == SheetFormat::Csv || format == SheetFormat::Tsv;
+    };
+    const SheetFormat format = sheetFormatOf(options.translationFilename);
+    if (!isWritable(format) && !isWritable(sheetFormatOf(options.outputFilename.empty() ? options.translationFilename : options.outputFilename)))
+    {
+        throw std::runtime_error("cannot write " + sheetFormatName(format) + " files, import into a CSV output file instead");
+    }
+    loadSheet(doc, options.translationFilename, readFile(options.translationFilename), options.columnNameIndex, options.rowNameIndex, options.dialect);
+
+    // The row a locale file was written from, see indexKeys().
+    const KeyIndex keyIndex = indexKeys(doc);
+    std::unordered_map<std::string_view, size_t> keyRows;
+    keyRows.reserve(keyIndex.keys.size());
+    for (size_t i = 0; i < keyIndex.keys.size(); i++)
+    {
+        keyRows.emplace(keyIndex.keys[i], keyIndex.rowIndices[i]);
+    }
+
+    for (auto &&[langName, localeFilename] : options.localeFilenames)
+    {
+        const size_t columnIdx = findColumn(doc, langName);
+        std::vector<size_t> fallbackColumnIdxs;
+        if (options.missingTranslation == MissingTranslation::Fallback)
+        {
+            for (auto &&fallbackLangName : options.fallbackLangNames)
+            {
+                const size_t fallbackColumnIdx = findColumn(doc, fallbackLangName);
+                if (fallbackColumnIdx != columnIdx)
+                {
+                    fallbackColumnIdxs.push_back(fallbackColumnIdx);
+                }
+            }
+        }
+        size_t &updatedCellCount = result.updatedCellCounts[langName];
+        std::vector<std::string> &unknownKeys = result.unknownKeys[langName];
+
+        const std::vector<char> data = readFile(localeFilename);
+        parseJsonObject(std::string_view(data.data(), data.size()), [&](std::string &&key, std::string &&text)
+        {
+            const auto it = keyRows.find(key);
+            if (it == keyRows.end())
+            {
+                unknownKeys.push_back(std::move(key));
+                return;
+            }
+
+            // Keep the cell when it still converts to the same text, e.g. with the literal \n
+            // sequences dropped by the conversion.
+            const std::string_view cell = doc.GetCell<std::string_view>(columnIdx, it->second);
+            if (isConvertedText(cell, text, options.shouldReplaceBreakLines))
+            {
+                return;
+            }
+            if (cell.empty())
+            {
+                // An empty cell was written with the first non-empty fallback cell, see collectEntries().
+                for (size_t fallbackColumnIdx : fallbackColumnIdxs)
+                {
+                    const std::string_view fallbackCell = doc.GetCell<std::string_view>(fallbackColumnIdx, it->second);
+                    if (!fallbackCell.empty())
+                    {
+                        if (isConvertedText(fallbackCell, text, options.shouldReplaceBreakLines))
+                        {
+                            return;
+                        }
+                        break;
+                    }
+                }
+            }
+
+            doc.SetCell<std::string>(columnIdx, it->second, text);
+            updatedCellCount++;
+        });
+    }
 
-    return duplicatedKeys;
+    doc.Save(options.outputFilename.empty() ? options.translationFilename : options.outputFilename);
+    return result;
 }
@@ -1,12 +1,286 @@
 #ifndef CONVERT_HPP
 #define CONVERT_HPP
 
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "dialect.hpp"
+#include "localediff.hpp"
+#include "sheetreader.hpp"
+#include "stats.hpp"
+
 namespace rapidcsv
 {
     class Document;
 }
 
-rapidcsv::Document readCvs(const std::string &filename, int columnNameIndex = 1, int rowNameIndex = 1);
+/**
+ * What to write for a key whose translation cell is empty.
+ */
+enum class MissingTranslation
+{
+    // Write the empty string.
+    Keep,
+    // Leave the key out, so i18next falls back to its fallback language.
+    Omit,
+    // Take the first non-empty cell of the fallback languages, otherwise leave the key out.
+    Fallback,
+};
+
+/**
+ * Options of a conversion from the translation file to the locale files.
+ */
+struct ConvertOptions
+{
+    std::string translationFilename;
+    std::string outputBaseFolder = "locales";
+    std::vector<std::string> langNames = {"en", "zh"};
+    int columnNameIndex = 1;
+    int rowNameIndex = 1;
+    // Dialect of a CSV translation file, sniffed from its start when not set.
+    std::optional<CsvDialect> dialect;
+    bool shouldReplaceBreakLines = true;
+    bool shouldRepairInvalidUtf8 = true;
+    bool shouldNormalizeNfc = false;
+    // Write the keys in byte order instead of sheet order, so the output does not change when
+    // rows are moved around.
+    bool shouldSortKeys = false;
+    // Output formats, see makeLocaleWriter().
+    std::vector<std::string> formats = {"json"};
+    MissingTranslation missingTranslation = MissingTranslation::Keep;
+    std::vector<std::string> fallbackLangNames = {"en"};
+    // Fail when a language misses translations for a larger share of the keys.
+    double maxMissingRatio = 1.0;
+    // Compare the placeholders of every language against this one, see checkPlaceholders().
+    bool shouldCheckPlaceholders = true;
+    std::string sourceLangName = "en";
+    // Language folder of a pseudo-locale generated from sourceLangName, e.g. "en-XA", written
+    // along the other languages in every format; none when empty. See appendPseudoText().
+    std::string pseudoLangName;
+    // Source folders scanned for the keys in use, see findUsedKeys(); none when empty.
+    std::vector<std::string> sourceFolders;
+    // Leave the keys unused by the source folders out of the locale files.
+    bool shouldStripUnusedKeys = false;
+    // Serial of the locale files to write.
+    std::string serial;
+    // Serials of the previous locale files, newest first.
+    std::vector<std::string> oldSerials;
+    // Previous versions kept next to the new one, each with a delta bundle to it.
+    size_t historySize = 0;
+    // JSON report of the conversion, not written when empty. A relative name is taken from the
+    // folder holding outputBaseFolder, so the report lands next to the locales folder.
+    std::string reportFilename = "conversion-report.json";
+};
+
+/**
+ * A written locale file.
+ */
+struct LocaleFile
+{
+    std::string langName;
+    std::string format;
+    std::string filename;
+    size_t byteCount = 0;
+    // Hex SHA-256 of the file content.
+    std::string sha256;
+    // Keys with an empty cell in this language.
+    std::vector<std::string> missingKeys;
+    // Missing keys written with the text of a fallback language.
+    size_t filledKeyCount = 0;
+};
+
+/**
+ * A key and its translation as it is in the sheet.
+ */
+struct LocaleEntry
+{
+    std::string_view key;
+    std::string_view text;
+};
+
+/**
+ * Output format of the locale files.
+ */
+class LocaleWriter
+{
+public:
+    virtual ~LocaleWriter() = default;
+
+    /**
+     * Name of the locale file of a serial in <outputBaseFolder>/<langName>/.
+     */
+    virtual std::string filename(const std::string &serial) const = 0;
+
+    /**
+     * Content of the locale file of one language.
+     */
+    virtual std::string write(const std::vector<LocaleEntry> &entries, const std::string &langName, bool shouldReplaceBreakLines) const = 0;
+};
+
+/**
+ * Writer of an output format: "json" (i18next), "po" and "mo" (gettext, keys as msgid),
+ * "android" (strings.xml), "ios" (Localizable.strings) or "bin" (binarylocale.hpp).
+ *
+ * Throws std::invalid_argument for other formats.
+ */
+std::unique_ptr<LocaleWriter> makeLocaleWriter(const std::string &format);
+
+/**
+ * Text of a cell as written between the quotes of a JSON locale file.
+ */
+std::string exportJsonText(std::string_view cell, bool shouldReplaceBreakLines);
+
+/**
+ * A translation whose placeholders differ from the source language.
+ */
+struct PlaceholderMismatch
+{
+    std::string langName;
+    std::string key;
+    // Document row, or sheet row (1-based) in ConvertResult.
+    size_t row = 0;
+    std::vector<std::string> sourcePlaceholders;
+    std::vector<std::string> placeholders;
+    // The translation has an unclosed interpolation, nesting or ICU argument.
+    bool isMalformed = false;
+};
+
+struct ConvertResult
+{
+    // Duplicated keys per language.
+    std::map<std::string, std::set<std::string>> duplicatedKeys;
+    // Sheet rows (1-based, as shown by spreadsheet editors) of every duplicated key.
+    std::map<std::string, std::vector<size_t>> duplicatedKeyRows;
+    // Keys with invalid UTF-8, see sanitizeUtf8().
+    std::set<std::string> invalidUtf8Keys;
+    // Keys not referenced from options.sourceFolders, in output order.
+    std::vector<std::string> unusedKeys;
+    std::vector<PlaceholderMismatch> placeholderMismatches;
+    // Format of the translation file, and for CSV the dialect it was read with.
+    SheetFormat format = SheetFormat::Csv;
+    CsvDialect dialect;
+    std::vector<LocaleFile> localeFiles;
+    // Changes since the locale files of the old serial, for the languages that had one.
+    std::vector<LocaleDiff> localeDiffs;
+    // Serials of the locale files on disk after the conversion, newest first, to be passed as
+    // oldSerials to the next one.
+    std::vector<std::string> serialHistory;
+    ConvertStats stats;
+};
+
+/**
+ * Keys of the translation file in sheet order, each appearing once.
+ */
+struct KeyIndex
+{
+    std::vector<std::string> keys;
+    // Row of each key. The text of a duplicated key comes from its last row.
+    std::vector<size_t> rowIndices;
+    std::set<std::string> duplicatedKeys;
+    // Document rows of every appearance of each duplicated key.
+    std::map<std::string, std::vector<size_t>> duplicatedKeyRows;
+};
+
+/**
+ * Read the translation file in the given dialect, or in the one sniffed from its start. Files
+ * of the other formats of sheetFormatOf() are read through a SheetReader instead.
+ */
+rapidcsv::Document readCvs(const std::string &filename, int columnNameIndex = 1, int rowNameIndex = 1, const std::optional<CsvDialect> &dialect = std::nullopt);
+std::set<std::string> sanitizeUtf8(rapidcsv::Document &doc, const std::vector<std::string> &columnNames, bool shouldRepair = true, bool shouldNormalize = false);
+KeyIndex indexKeys(const rapidcsv::Document &doc);
+
+/**
+ * Sort the indexed keys in byte order, i.e. by code point, on all cores.
+ */
+void sortKeys(KeyIndex &keyIndex);
+
+/**
+ * Compare the placeholders of each translation with those of the source language, one thread
+ * per language. Empty cells are skipped.
+ */
+std::vector<PlaceholderMismatch> checkPlaceholders(const rapidcsv::Document &doc, const KeyIndex &keyIndex, const std::string &sourceLangName, const std::vector<std::string> &langNames);
 std::set<std::string> writeJson(const rapidcsv::Document &doc, const std::string &columnName, const std::string &filename, bool shouldReplaceBreakLines = true);
 
+/**
+ * Write the translations of one language column of the indexed keys to a json file,
+ * collecting the keys with an empty cell on the way.
+ */
+LocaleFile writeJson(const rapidcsv::Document &doc, const KeyIndex &keyIndex, const std::string &columnName, const std::string &filename, bool shouldReplaceBreakLines = true,
+                     MissingTranslation missingTranslation = MissingTranslation::Keep, const std::vector<std::string> &fallbackLangNames = {});
+
+/**
+ * Entries of one language column of the indexed keys, with empty cells handled as
+ * missingTranslation says. The entries point into doc and keyIndex; the keys with an empty cell
+ * and the filled count are recorded in coverage.
+ */
+std::vector<LocaleEntry> collectEntries(const rapidcsv::Document &doc, const KeyIndex &keyIndex, const std::string &columnName,
+                                        MissingTranslation missingTranslation, const std::vector<std::string> &fallbackLangNames, LocaleFile &coverage);
+
+/**
+ * Convert the translation file to one locale file per language, written to
+ * <outputBaseFolder>/<langName>/common-<serial>.json.
+ *
+ * The new locale files are compared with those of the newest old serial. The first
+ * options.historySize old versions are kept and get a delta bundle
+ * <langName>/delta-<oldSerial>-<serial>.json to the new version, listed in <langName>/index.json;
+ * older versions are removed.
+ *
+ * Throws std::runtime_error, after removing the written locale files, when a language misses
+ * more translations than options.maxMissingRatio allows. The old files are kept then.
+ */
+ConvertResult convertTranslations(const ConvertOptions &options);
+
+/**
+ * Options of an import of locale files back into the translation file.
+ */
+struct ImportOptions
+{
+    std::string translationFilename;
+    // Written in place of the translation file when empty. Required for a translation file
+    // that is not CSV, the import is saved as CSV.
+    std::string outputFilename;
+    // Locale file of each language column to update.
+    std::map<std::string, std::string> localeFilenames;
+    int columnNameIndex = 1;
+    int rowNameIndex = 1;
+    // Dialect of the translation file, sniffed from its start when not set. The file is saved
+    // in the same dialect.
+    std::optional<CsvDialect> dialect;
+    // The locale files were converted with shouldReplaceBreakLines.
+    bool shouldReplaceBreakLines = true;
+    // The locale files were converted with missingTranslation and fallbackLangNames, so a
+    // fallback text in place of an empty cell is not imported.
+    MissingTranslation missingTranslation = MissingTranslation::Keep;
+    std::vector<std::string> fallbackLangNames = {"en"};
+    // Pseudo-locale of the conversion, refused as it is generated from the source language.
+    std::string pseudoLangName;
+};
+
+struct ImportResult
+{
+    // Cells changed per language.
+    std::map<std::string, size_t> updatedCellCounts;
+    // Keys of the locale files missing from the translation file, per language. They are not added.
+    std::map<std::string, std::vector<std::string>> unknownKeys;
+};
+
+/**
+ * Update the language columns of the translation file from locale files, e.g. corrected by a
+ * vendor, and save it. Row order and the cells whose text did not change are kept; keys
+ * missing from a locale file are left untouched, and so are the empty cells given the text
+ * of their fallback language.
+ *
+ * Throws std::invalid_argument for a locale file of the pseudo-locale.
+ */
+ImportResult importTranslations(const ImportOptions &options);
+
+/**
+ * Serialize the options and result of a conversion as a JSON report.
+ */
+std::string reportToJson(const ConvertOptions &options, const ConvertResult &result);
+
 #endif // CONVERT_HPP
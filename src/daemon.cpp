@@ -0,0 +1,214 @@
+#include "daemon.hpp"
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUrl>
+#include "service.hpp"
+
+static const qsizetype maxRequestSize = 64 * 1024;
+static const size_t maxHitCount = 100;
+
+struct HttpResponse
+{
+    int status = 200;
+    std::string contentType = "application/json; charset=utf-8";
+    std::string body;
+};
+
+static std::vector<std::string> splitPath(const std::string &path)
+{
+    std::vector<std::string> segments;
+    size_t start = 1;
+    while (start <= path.size())
+    {
+        size_t end = path.find('/', start);
+        end = end == std::string::npos ? path.size() : end;
+        if (end > start)
+        {
+            const QByteArray segment(path.data() + start, static_cast<qsizetype>(end - start));
+            segments.push_back(QUrl::fromPercentEncoding(segment).toStdString());
+        }
+        start = end + 1;
+    }
+    return segments;
+}
+
+static HttpResponse handleRequest(TranslationService &service, const std::string &method, const std::string &path)
+{
+    HttpResponse response;
+    if (method != "GET")
+    {
+        response.status = 405;
+        return response;
+    }
+
+    try
+    {
+        if (service.reload())
+        {
+            std::cerr << "Loaded translation file\n";
+        }
+    }
+    catch (const std::exception &e)
+    {
+        // E.g. an editor still writing the file: the version loaded before is served.
+        std::cerr << e.what() << '\n';
+        if (!service.isLoaded())
+        {
+            response.status = 500;
+            response.contentType = "text/plain; charset=utf-8";
+            response.body = e.what();
+            return response;
+        }
+    }
+
+    const std::vector<std::string> segments = splitPath(path.substr(0, path.find('?')));
+    try
+    {
+        if (segments.size() >= 2 && segments.size() <= 3 && segments[0] == "render")
+        {
+            const std::string format = segments.size() == 3 ? segments[2] : "json";
+            response.body = service.render(segments[1], format);
+            if (format != "json")
+            {
+                response.contentType = format == "mo" || format == "bin" ? "application/octet-stream" : "text/plain; charset=utf-8";
+            }
+        }
+        else if (segments.size() == 2 && segments[0] == "lookup")
+        {
+            const std::optional<std::string> json = service.lookup(segments[1]);
+            response.status = json ? 200 : 404;
+            response.body = json.value_or("");
+        }
+        else if (segments.size() == 3 && segments[0] == "export")
+        {
+            response.body = service.exportNamespace(segments[1], segments[2]);
+        }
+        else if (segments.size() == 2 && segments[0] == "search")
+        {
+            response.body = searchHitsToJson(service.search(segments[1], maxHitCount));
+        }
+        else
+        {
+            response.status = 404;
+        }
+    }
+    catch (const std::out_of_range &e)
+    {
+        // Unknown language.
+        response.status = 404;
+        response.contentType = "text/plain; charset=utf-8";
+        response.body = e.what();
+    }
+    catch (const std::invalid_argument &e)
+    {
+        // Unknown format.
+        response.status = 400;
+        response.contentType = "text/plain; charset=utf-8";
+        response.body = e.what();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << '\n';
+        response.status = 500;
+        response.contentType = "text/plain; charset=utf-8";
+        response.body = e.what();
+    }
+    return response;
+}
+
+static std::string statusText(int status)
+{
+    switch (status)
+    {
+    case 200:
+        return "OK";
+    case 400:
+        return "Bad Request";
+    case 404:
+        return "Not Found";
+    case 405:
+        return "Method Not Allowed";
+    default:
+        return "Internal Server Error";
+    }
+}
+
+int runDaemon(int argc, char **argv, const ConvertOptions &options, uint16_t port)
+{
+    QCoreApplication app(argc, argv);
+    TranslationService service(options);
+    try
+    {
+        service.reload();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    QTcpServer server;
+    // Local tooling only, the service is not exposed to the network.
+    if (!server.listen(QHostAddress::LocalHost, port))
+    {
+        std::cerr << "cannot listen on port " << port << ": " << server.errorString().toStdString() << '\n';
+        return 1;
+    }
+    std::cerr << "Listening on http://127.0.0.1:" << server.serverPort() << "/\n";
+
+    QObject::connect(&server, &QTcpServer::newConnection, [&]()
+    {
+        while (QTcpSocket *socket = server.nextPendingConnection())
+        {
+            QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            auto request = std::make_shared<QByteArray>();
+            QObject::connect(socket, &QTcpSocket::readyRead, socket, [&service, socket, request]()
+            {
+                request->append(socket->readAll());
+                // The request line and headers; GET requests have no body.
+                if (request->indexOf("\r\n\r\n") < 0)
+                {
+                    if (request->size() > maxRequestSize)
+                    {
+                        socket->abort();
+                    }
+                    return;
+                }
+                // One request per connection.
+                QObject::disconnect(socket, &QTcpSocket::readyRead, nullptr, nullptr);
+
+                const std::string requestLine = request->left(request->indexOf("\r\n")).toStdString();
+                const size_t methodEnd = requestLine.find(' ');
+                const size_t pathEnd = requestLine.find(' ', methodEnd + 1);
+                HttpResponse response;
+                if (methodEnd == std::string::npos || pathEnd == std::string::npos)
+                {
+                    response.status = 400;
+                }
+                else
+                {
+                    response = handleRequest(service, requestLine.substr(0, methodEnd), requestLine.substr(methodEnd + 1, pathEnd - methodEnd - 1));
+                }
+
+                std::string header = "HTTP/1.1 " + std::to_string(response.status) + " " + statusText(response.status) + "\r\n";
+                header += "Content-Type: " + response.contentType + "\r\n";
+                header += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
+                // Dev servers of the web clients fetch from another port.
+                header += "Access-Control-Allow-Origin: *\r\n";
+                header += "Connection: close\r\n\r\n";
+                socket->write(header.data(), static_cast<qint64>(header.size()));
+                socket->write(response.body.data(), static_cast<qint64>(response.body.size()));
+                socket->disconnectFromHost();
+            });
+        }
+    });
+
+    return app.exec();
+}
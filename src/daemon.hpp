@@ -0,0 +1,21 @@
+#ifndef DAEMON_HPP
+#define DAEMON_HPP
+
+#include <cstdint>
+#include "convert.hpp"
+
+/**
+ * Serve the translation file over HTTP on 127.0.0.1:port until the process is stopped:
+ *
+ *   GET /render/<lang>[/<format>]    locale file of a language, JSON by default
+ *   GET /lookup/<key>                text of a key in every language
+ *   GET /export/<namespace>/<lang>   JSON of the keys under "<namespace>."
+ *   GET /search/<text>               first 100 keys and cells containing the text
+ *
+ * The file is parsed again only when it changed, see TranslationService.
+ *
+ * @return The exit code of the CLI.
+ */
+int runDaemon(int argc, char **argv, const ConvertOptions &options, uint16_t port);
+
+#endif // DAEMON_HPP
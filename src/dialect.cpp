@@ -0,0 +1,147 @@
+#include "dialect.hpp"
+#include <algorithm>
+#include <map>
+#include <vector>
+
+static const char separators[] = {',', ';', '\t', '|'};
+static const char quoteChars[] = {'"', '\''};
+
+struct DialectScore
+{
+    size_t score = 0;
+    // Non-empty cells after the first of a row, and those starting with a space.
+    size_t cellCount = 0;
+    size_t spacedCellCount = 0;
+};
+
+/**
+ * Split the sample into rows the way rapidcsv does: a quote toggles quoting at the start of a
+ * cell, after leading spaces too since those are trimmed, and anywhere in a cell that started
+ * with one, so "" inside a quoted cell is kept.
+ */
+static DialectScore scoreDialect(std::string_view sample, bool isWholeData, char separator, char quoteChar)
+{
+    DialectScore dialectScore;
+    std::vector<size_t> rowCellCounts;
+    size_t cellCount = 1;
+    size_t cellSize = 0;
+    bool isCellBlank = true;
+    bool isQuoted = false;
+    bool isQuotedCell = false;
+    const auto endCell = [&](size_t cellStart)
+    {
+        if (cellCount > 1 && cellSize > 0)
+        {
+            dialectScore.cellCount++;
+            dialectScore.spacedCellCount += sample[cellStart] == ' ';
+        }
+    };
+
+    size_t cellStart = 0;
+    for (size_t i = 0; i < sample.size(); i++)
+    {
+        const char c = sample[i];
+        if (c == quoteChar && (isCellBlank || isQuotedCell))
+        {
+            isQuoted = !isQuoted;
+            isQuotedCell = true;
+        }
+        else if (!isQuoted && c == separator)
+        {
+            endCell(cellStart);
+            cellCount++;
+            cellSize = 0;
+            cellStart = i + 1;
+            isCellBlank = true;
+            isQuotedCell = false;
+            continue;
+        }
+        else if (!isQuoted && (c == '\n' || c == '\r'))
+        {
+            endCell(cellStart);
+            if (cellCount > 1 || cellSize > 0)
+            {
+                rowCellCounts.push_back(cellCount);
+            }
+            cellCount = 1;
+            cellSize = 0;
+            cellStart = i + 1;
+            isCellBlank = true;
+            isQuotedCell = false;
+            continue;
+        }
+        cellSize++;
+        isCellBlank = isCellBlank && c == ' ';
+    }
+    // A row cut by the end of the sample is left out.
+    if (isWholeData && !isQuoted && (cellCount > 1 || cellSize > 0))
+    {
+        endCell(cellStart);
+        rowCellCounts.push_back(cellCount);
+    }
+
+    std::map<size_t, size_t> rowCounts;
+    for (size_t count : rowCellCounts)
+    {
+        rowCounts[count]++;
+    }
+    for (auto &&[count, rowCount] : rowCounts)
+    {
+        dialectScore.score = std::max(dialectScore.score, rowCount * (count - 1));
+    }
+    return dialectScore;
+}
+
+CsvDialect sniffDialect(std::string_view data, size_t sampleSize)
+{
+    const std::string_view sample = data.substr(0, sampleSize);
+    CsvDialect dialect;
+    DialectScore bestScore;
+    // Candidates in order of preference, replaced only by a higher score.
+    for (char quoteChar : quoteChars)
+    {
+        for (char separator : separators)
+        {
+            const DialectScore score = scoreDialect(sample, sample.size() == data.size(), separator, quoteChar);
+            if (score.score > bestScore.score)
+            {
+                bestScore = score;
+                dialect.separator = separator;
+                dialect.quoteChar = quoteChar;
+            }
+        }
+    }
+
+    // Trimming loses text, so only when nearly every cell starts with a space.
+    dialect.shouldTrim = bestScore.cellCount >= 4 && bestScore.spacedCellCount * 10 >= bestScore.cellCount * 9;
+    return dialect;
+}
+
+std::string separatorName(char separator)
+{
+    switch (separator)
+    {
+    case ',':
+        return "comma";
+    case ';':
+        return "semicolon";
+    case '\t':
+        return "tab";
+    case '|':
+        return "pipe";
+    default:
+        return std::string(1, separator);
+    }
+}
+
+char parseSeparator(const std::string &name)
+{
+    for (char separator : separators)
+    {
+        if (name == separatorName(separator))
+        {
+            return separator;
+        }
+    }
+    return name.size() == 1 ? name[0] : 0;
+}
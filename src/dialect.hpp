@@ -0,0 +1,37 @@
+#ifndef DIALECT_HPP
+#define DIALECT_HPP
+
+#include <string>
+#include <string_view>
+
+/**
+ * How the cells of a CSV file are separated and quoted.
+ */
+struct CsvDialect
+{
+    char separator = ',';
+    char quoteChar = '"';
+    // Leading and trailing spaces of the cells are not part of the text, e.g. in "a, b, c".
+    bool shouldTrim = false;
+};
+
+/**
+ * Guess the dialect of CSV data from its first sampleSize bytes.
+ *
+ * Each candidate separator (comma, semicolon, tab, pipe) and quote character (double or single
+ * quote) is scored by how many sampled rows have the most common cell count, times the cells
+ * beyond the first. The comma and double quote are taken when nothing splits the rows.
+ */
+CsvDialect sniffDialect(std::string_view data, size_t sampleSize = 16 * 1024);
+
+/**
+ * Name of a separator as shown to users, e.g. "comma" or "tab".
+ */
+std::string separatorName(char separator);
+
+/**
+ * Separator named by separatorName(), or the character itself, 0 for anything else.
+ */
+char parseSeparator(const std::string &name);
+
+#endif // DIALECT_HPP
@@ -0,0 +1,114 @@
+#include "filereader.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+std::vector<char> readFile(const std::string &filename)
+{
+    const std::filesystem::path path = std::filesystem::u8path(filename);
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Failed to open " + filename);
+    }
+
+    std::vector<char> data;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to get the size of " + filename);
+    }
+    data.resize(static_cast<size_t>(size.QuadPart));
+
+    size_t offset = 0;
+    while (offset < data.size())
+    {
+        const DWORD toRead = static_cast<DWORD>(std::min<size_t>(data.size() - offset, 1 << 30));
+        DWORD readSize = 0;
+        if (!ReadFile(file, data.data() + offset, toRead, &readSize, nullptr))
+        {
+            CloseHandle(file);
+            throw std::runtime_error("Failed to read " + filename);
+        }
+        if (readSize == 0)
+        {
+            // File shrank since its size was taken.
+            break;
+        }
+        offset += readSize;
+    }
+    CloseHandle(file);
+
+    data.resize(offset);
+    return data;
+}
+
+#else
+
+std::vector<char> readFile(const std::string &filename)
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Failed to open " + filename + ": " + std::strerror(errno));
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0)
+    {
+        const int error = errno;
+        close(fd);
+        throw std::runtime_error("Failed to get the size of " + filename + ": " + std::strerror(error));
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    std::vector<char> data(static_cast<size_t>(status.st_size));
+    size_t offset = 0;
+    while (offset < data.size())
+    {
+        const ssize_t readSize = read(fd, data.data() + offset, data.size() - offset);
+        if (readSize < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            const int error = errno;
+            close(fd);
+            throw std::runtime_error("Failed to read " + filename + ": " + std::strerror(error));
+        }
+        if (readSize == 0)
+        {
+            // File shrank since its size was taken.
+            break;
+        }
+        offset += static_cast<size_t>(readSize);
+    }
+    close(fd);
+
+    data.resize(offset);
+    return data;
+}
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef FILE_READER_HPP
+#define FILE_READER_HPP
+
+#include <string>
+#include <vector>
+
+/**
+ * Read a whole file in binary mode.
+ *
+ * The buffer is allocated once from the file size and filled with large reads, the OS is
+ * told the file is read sequentially where supported.
+ *
+ * @param filename UTF-8 encoded file name.
+ * @return The exact bytes of the file.
+ */
+std::vector<char> readFile(const std::string &filename);
+
+#endif // FILE_READER_HPP
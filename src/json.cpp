@@ -0,0 +1,270 @@
+#include "json.hpp"
+#include <cstdint>
+#include <stdexcept>
+#include "utf8.hpp"
+
+std::string quoteJson(std::string_view text)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    std::string quoted;
+    quoted.reserve(text.size() + 2);
+    quoted += '"';
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '"':
+            quoted += "\\\"";
+            break;
+        case '\\':
+            quoted += "\\\\";
+            break;
+        case '\n':
+            quoted += "\\n";
+            break;
+        case '\r':
+            quoted += "\\r";
+            break;
+        case '\t':
+            quoted += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                quoted += "\\u00";
+                quoted += hexDigits[(c >> 4) & 0x0f];
+                quoted += hexDigits[c & 0x0f];
+            }
+            else
+            {
+                quoted += c;
+            }
+        }
+    }
+    quoted += '"';
+    return quoted;
+}
+
+std::string quoteJsonList(const std::vector<std::string> &items)
+{
+    std::string list = "[";
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        list += i > 0 ? ", " : "";
+        list += quoteJson(items[i]);
+    }
+    list += "]";
+    return list;
+}
+
+namespace
+{
+    class JsonParser
+    {
+    public:
+        JsonParser(std::string_view json, const std::function<void(std::string &&, std::string &&)> &onEntry)
+            : json(json), onEntry(onEntry)
+        {
+        }
+
+        void parse()
+        {
+            skipSpace();
+            parseObject("");
+            skipSpace();
+            if (pos != json.size())
+            {
+                fail("trailing characters");
+            }
+        }
+
+        std::string parseLiteral()
+        {
+            std::string text = parseString();
+            if (pos != json.size())
+            {
+                fail("trailing characters");
+            }
+            return text;
+        }
+
+    private:
+        std::string_view json;
+        const std::function<void(std::string &&, std::string &&)> &onEntry;
+        size_t pos = 0;
+
+        [[noreturn]] void fail(const char *message) const
+        {
+            throw std::runtime_error(std::string("invalid JSON at offset ") + std::to_string(pos) + ": " + message);
+        }
+
+        void skipSpace()
+        {
+            while (pos < json.size() && (json[pos] == ' ' || json[pos] == '\t' || json[pos] == '\n' || json[pos] == '\r'))
+            {
+                pos++;
+            }
+        }
+
+        void expect(char c)
+        {
+            if (pos >= json.size() || json[pos] != c)
+            {
+                fail(c == '"' ? "expected a string" : "unexpected character");
+            }
+            pos++;
+        }
+
+        void parseObject(const std::string &prefix)
+        {
+            expect('{');
+            skipSpace();
+            if (pos < json.size() && json[pos] == '}')
+            {
+                pos++;
+                return;
+            }
+
+            while (true)
+            {
+                skipSpace();
+                std::string key = prefix + parseString();
+                skipSpace();
+                expect(':');
+                skipSpace();
+                if (pos < json.size() && json[pos] == '{')
+                {
+                    parseObject(key + ".");
+                }
+                else
+                {
+                    onEntry(std::move(key), parseString());
+                }
+                skipSpace();
+                if (pos < json.size() && json[pos] == ',')
+                {
+                    pos++;
+                    continue;
+                }
+                expect('}');
+                return;
+            }
+        }
+
+        uint32_t parseHex4()
+        {
+            if (pos + 4 > json.size())
+            {
+                fail("truncated \\u escape");
+            }
+            uint32_t value = 0;
+            for (size_t end = pos + 4; pos < end; pos++)
+            {
+                const char c = json[pos];
+                value <<= 4;
+                if (c >= '0' && c <= '9')
+                {
+                    value |= c - '0';
+                }
+                else if (c >= 'a' && c <= 'f')
+                {
+                    value |= c - 'a' + 10;
+                }
+                else if (c >= 'A' && c <= 'F')
+                {
+                    value |= c - 'A' + 10;
+                }
+                else
+                {
+                    fail("invalid \\u escape");
+                }
+            }
+            return value;
+        }
+
+        std::string parseString()
+        {
+            expect('"');
+            std::string text;
+            while (true)
+            {
+                // Copy the run up to the next quote or escape at once.
+                const size_t end = json.find_first_of("\"\\", pos);
+                if (end == std::string_view::npos)
+                {
+                    fail("unterminated string");
+                }
+                text.append(json.data() + pos, end - pos);
+                pos = end + 1;
+                if (json[end] == '"')
+                {
+                    return text;
+                }
+
+                if (pos >= json.size())
+                {
+                    fail("unterminated string");
+                }
+                const char escape = json[pos++];
+                switch (escape)
+                {
+                case '"':
+                case '\\':
+                case '/':
+                    text += escape;
+                    break;
+                case 'b':
+                    text += '\b';
+                    break;
+                case 'f':
+                    text += '\f';
+                    break;
+                case 'n':
+                    text += '\n';
+                    break;
+                case 'r':
+                    text += '\r';
+                    break;
+                case 't':
+                    text += '\t';
+                    break;
+                case 'u':
+                {
+                    uint32_t codePoint = parseHex4();
+                    if (codePoint >= 0xd800 && codePoint <= 0xdbff && json.compare(pos, 2, "\\u") == 0)
+                    {
+                        const size_t lowPos = pos;
+                        pos += 2;
+                        const uint32_t low = parseHex4();
+                        if (low >= 0xdc00 && low <= 0xdfff)
+                        {
+                            codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+                        }
+                        else
+                        {
+                            // Not a pair, the second escape is decoded on its own.
+                            pos = lowPos;
+                        }
+                    }
+                    // Unpaired surrogates become U+FFFD.
+                    appendUtf8(text, codePoint >= 0xd800 && codePoint <= 0xdfff ? 0xfffd : codePoint);
+                    break;
+                }
+                default:
+                    pos--;
+                    fail("invalid escape");
+                }
+            }
+        }
+    };
+}
+
+void parseJsonObject(std::string_view json, const std::function<void(std::string &&key, std::string &&value)> &onEntry)
+{
+    JsonParser(json, onEntry).parse();
+}
+
+std::string unquoteJson(std::string_view literal)
+{
+    return JsonParser(literal, nullptr).parseLiteral();
+}
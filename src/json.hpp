@@ -0,0 +1,34 @@
+#ifndef JSON_HPP
+#define JSON_HPP
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Quote and escape a UTF-8 string as a JSON string literal.
+ */
+std::string quoteJson(std::string_view text);
+
+/**
+ * Decode a JSON string literal, quotes included.
+ *
+ * Throws std::runtime_error when the literal is malformed.
+ */
+std::string unquoteJson(std::string_view literal);
+
+/**
+ * Serialize strings as a single-line JSON array.
+ */
+std::string quoteJsonList(const std::vector<std::string> &items);
+
+/**
+ * Parse a JSON object whose values are strings or nested objects, calling onEntry for every
+ * string in document order. Keys of nested objects are joined with '.', as i18next does.
+ *
+ * Throws std::runtime_error on malformed JSON or values of other types.
+ */
+void parseJsonObject(std::string_view json, const std::function<void(std::string &&key, std::string &&value)> &onEntry);
+
+#endif // JSON_HPP
@@ -0,0 +1,153 @@
+#include "keyusage.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <set>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include "filereader.hpp"
+
+// Longest quoted string looked up, keys are shorter.
+static const size_t maxKeySize = 512;
+
+static const std::set<std::string> sourceExtensions = {".js", ".jsx", ".mjs", ".cjs", ".ts", ".tsx", ".vue", ".svelte", ".html"};
+
+// Suffixes added by i18next to the key passed to t() with a count.
+static const char *const pluralSuffixes[] = {"_zero", "_one", "_two", "_few", "_many", "_other", "_plural"};
+
+static std::vector<std::filesystem::path> listSourceFiles(const std::vector<std::string> &folders)
+{
+    std::vector<std::filesystem::path> paths;
+    for (auto &&folder : folders)
+    {
+        const std::filesystem::path folderPath = std::filesystem::u8path(folder);
+        if (!std::filesystem::is_directory(folderPath))
+        {
+            throw std::runtime_error("source folder not found: " + folder);
+        }
+        for (auto it = std::filesystem::recursive_directory_iterator(folderPath, std::filesystem::directory_options::skip_permission_denied);
+             it != std::filesystem::recursive_directory_iterator(); ++it)
+        {
+            const std::string name = it->path().filename().u8string();
+            if (it->is_directory())
+            {
+                if (name == "node_modules" || (name.size() > 1 && name[0] == '.'))
+                {
+                    it.disable_recursion_pending();
+                }
+            }
+            else if (it->is_regular_file() && sourceExtensions.count(it->path().extension().u8string()) > 0)
+            {
+                paths.push_back(it->path());
+            }
+        }
+    }
+    return paths;
+}
+
+/**
+ * Flag the keys named by the quoted strings of a source file.
+ */
+static void markUsedKeys(std::string_view source, const std::unordered_multimap<std::string_view, size_t> &keyPositions, std::vector<char> &isUsed)
+{
+    const auto mark = [&](std::string_view name)
+    {
+        const auto range = keyPositions.equal_range(name);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            isUsed[it->second] = 1;
+        }
+    };
+
+    // Every quote is tried as an opening one up to the next quote of its kind on the line, so
+    // that an apostrophe in a comment cannot shift the pairing of the quotes after it.
+    for (size_t i = 0; i < source.size(); i++)
+    {
+        const char quote = source[i];
+        if (quote != '\'' && quote != '"' && quote != '`')
+        {
+            continue;
+        }
+        const size_t searchSize = std::min(source.size() - i - 1, maxKeySize + 1);
+        const char *end = static_cast<const char *>(std::memchr(source.data() + i + 1, quote, searchSize));
+        if (end == nullptr)
+        {
+            continue;
+        }
+        const std::string_view name(source.data() + i + 1, static_cast<size_t>(end - source.data()) - i - 1);
+        if (name.empty() || name.find('\n') != std::string_view::npos)
+        {
+            continue;
+        }
+        mark(name);
+        const size_t namespaceEnd = name.find(':');
+        if (namespaceEnd != std::string_view::npos)
+        {
+            mark(name.substr(namespaceEnd + 1));
+        }
+    }
+}
+
+std::vector<bool> findUsedKeys(const KeyIndex &keyIndex, const std::vector<std::string> &folders)
+{
+    // Each key under its own name, and plural keys under their base key too.
+    std::unordered_multimap<std::string_view, size_t> keyPositions;
+    keyPositions.reserve(keyIndex.keys.size());
+    for (size_t i = 0; i < keyIndex.keys.size(); i++)
+    {
+        const std::string_view key = keyIndex.keys[i];
+        keyPositions.emplace(key, i);
+        for (const char *suffix : pluralSuffixes)
+        {
+            const size_t suffixSize = std::strlen(suffix);
+            if (key.size() > suffixSize && key.compare(key.size() - suffixSize, suffixSize, suffix) == 0)
+            {
+                // item_ordinal_one is requested as item with ordinal: true.
+                std::string_view baseKey = key.substr(0, key.size() - suffixSize);
+                if (baseKey.size() > 8 && baseKey.compare(baseKey.size() - 8, 8, "_ordinal") == 0)
+                {
+                    baseKey.remove_suffix(8);
+                }
+                keyPositions.emplace(baseKey, i);
+                break;
+            }
+        }
+    }
+
+    const std::vector<std::filesystem::path> paths = listSourceFiles(folders);
+    const size_t threadCount = std::max<size_t>(std::min<size_t>(std::thread::hardware_concurrency(), paths.size()), 1);
+    std::atomic<size_t> nextPath(0);
+    std::vector<std::future<std::vector<char>>> futures;
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        // Files are taken one by one, their sizes vary too much to split the list evenly.
+        futures.push_back(std::async(std::launch::async, [&]()
+        {
+            std::vector<char> isUsed(keyIndex.keys.size(), 0);
+            for (size_t j = nextPath++; j < paths.size(); j = nextPath++)
+            {
+                const std::vector<char> data = readFile(paths[j].u8string());
+                markUsedKeys(std::string_view(data.data(), data.size()), keyPositions, isUsed);
+            }
+            return isUsed;
+        }));
+    }
+
+    std::vector<bool> isUsed(keyIndex.keys.size(), false);
+    for (auto &&future : futures)
+    {
+        const std::vector<char> threadIsUsed = future.get();
+        for (size_t i = 0; i < threadIsUsed.size(); i++)
+        {
+            if (threadIsUsed[i])
+            {
+                isUsed[i] = true;
+            }
+        }
+    }
+    return isUsed;
+}
@@ -0,0 +1,20 @@
+#ifndef KEY_USAGE_HPP
+#define KEY_USAGE_HPP
+
+#include <string>
+#include <vector>
+#include "convert.hpp"
+
+/**
+ * Flag the keys of keyIndex that the source files under folders refer to, by key position.
+ *
+ * Every quoted string in the .js, .jsx, .mjs, .cjs, .ts, .tsx, .vue, .svelte and .html files is
+ * looked up as a key, e.g. t('menu.open'), i18nKey="menu.open" or `menu.open`, also without a
+ * "namespace:" prefix. A plural key such as item_one or item_other counts as used when its base
+ * key item is. Keys built at runtime, e.g. t(`menu.${name}`), are not found.
+ *
+ * node_modules and hidden folders are skipped. The files are read on all cores.
+ */
+std::vector<bool> findUsedKeys(const KeyIndex &keyIndex, const std::vector<std::string> &folders);
+
+#endif // KEY_USAGE_HPP
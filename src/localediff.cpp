@@ -0,0 +1,89 @@
+#include "localediff.hpp"
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include "filereader.hpp"
+#include "json.hpp"
+
+LocaleEntries readLocaleFile(const std::string &filename)
+{
+    const std::vector<char> data = readFile(filename);
+    LocaleEntries entries;
+    parseJsonObject(std::string_view(data.data(), data.size()), [&](std::string &&key, std::string &&text)
+    {
+        entries.emplace_back(std::move(key), std::move(text));
+    });
+    return entries;
+}
+
+LocaleDiff diffLocales(const LocaleEntries &oldEntries, const LocaleEntries &newEntries)
+{
+    LocaleDiff diff;
+
+    // Views into the entries, so building the tables copies no text.
+    std::unordered_map<std::string_view, std::string_view> oldTexts;
+    oldTexts.reserve(oldEntries.size());
+    for (auto &&[key, text] : oldEntries)
+    {
+        oldTexts[key] = text;
+    }
+    std::unordered_set<std::string_view> newKeys;
+    newKeys.reserve(newEntries.size());
+
+    for (auto &&[key, text] : newEntries)
+    {
+        newKeys.insert(key);
+        const auto it = oldTexts.find(key);
+        if (it == oldTexts.end())
+        {
+            diff.addedKeys.push_back(key);
+        }
+        else if (it->second != text)
+        {
+            diff.changedKeys.push_back(key);
+        }
+    }
+    for (auto &&[key, text] : oldEntries)
+    {
+        if (newKeys.find(key) == newKeys.end())
+        {
+            diff.removedKeys.push_back(key);
+        }
+    }
+    return diff;
+}
+
+std::string diffToJson(const LocaleDiff &diff)
+{
+    return "{\"language\": " + quoteJson(diff.langName) +
+           ", \"added\": " + quoteJsonList(diff.addedKeys) +
+           ", \"changed\": " + quoteJsonList(diff.changedKeys) +
+           ", \"removed\": " + quoteJsonList(diff.removedKeys) + "}";
+}
+
+std::string deltaToJson(const std::string &fromSerial, const std::string &toSerial, const LocaleDiff &diff, const LocaleEntries &newEntries)
+{
+    std::unordered_set<std::string_view> setKeys;
+    setKeys.reserve(diff.addedKeys.size() + diff.changedKeys.size());
+    setKeys.insert(diff.addedKeys.begin(), diff.addedKeys.end());
+    setKeys.insert(diff.changedKeys.begin(), diff.changedKeys.end());
+
+    std::string delta = "{\n";
+    delta += "  \"from\": " + quoteJson(fromSerial) + ",\n";
+    delta += "  \"to\": " + quoteJson(toSerial) + ",\n";
+    delta += "  \"set\": {";
+    bool isFirst = true;
+    for (auto &&[key, text] : newEntries)
+    {
+        if (setKeys.find(key) != setKeys.end())
+        {
+            delta += isFirst ? "\n    " : ",\n    ";
+            isFirst = false;
+            delta += quoteJson(key) + ": " + quoteJson(text);
+        }
+    }
+    delta += isFirst ? "},\n" : "\n  },\n";
+    delta += "  \"remove\": " + quoteJsonList(diff.removedKeys) + "\n";
+    delta += "}\n";
+    return delta;
+}
@@ -0,0 +1,54 @@
+#ifndef LOCALE_DIFF_HPP
+#define LOCALE_DIFF_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Key and text pairs of a locale file, in file order.
+ */
+typedef std::vector<std::pair<std::string, std::string>> LocaleEntries;
+
+/**
+ * Changes between two versions of a locale file.
+ */
+struct LocaleDiff
+{
+    std::string langName;
+    // In the order of the new file.
+    std::vector<std::string> addedKeys;
+    std::vector<std::string> changedKeys;
+    // In the order of the old file.
+    std::vector<std::string> removedKeys;
+
+    bool empty() const
+    {
+        return addedKeys.empty() && changedKeys.empty() && removedKeys.empty();
+    }
+};
+
+/**
+ * Read a locale file written by writeJson.
+ *
+ * Throws std::runtime_error when the file cannot be read or is not valid JSON.
+ */
+LocaleEntries readLocaleFile(const std::string &filename);
+
+/**
+ * Compare two versions of a locale by joining their key tables on hash tables.
+ */
+LocaleDiff diffLocales(const LocaleEntries &oldEntries, const LocaleEntries &newEntries);
+
+/**
+ * Serialize a diff as a JSON object.
+ */
+std::string diffToJson(const LocaleDiff &diff);
+
+/**
+ * Serialize the delta bundle that patches the old version of a locale into the new one:
+ * {"from": ..., "to": ..., "set": {added and changed keys}, "remove": [removed keys]}.
+ */
+std::string deltaToJson(const std::string &fromSerial, const std::string &toSerial, const LocaleDiff &diff, const LocaleEntries &newEntries);
+
+#endif // LOCALE_DIFF_HPP
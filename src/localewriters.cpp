@@ -0,0 +1,708 @@
+#include "convert.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include "binarylocale.hpp"
+#include "json.hpp"
+
+std::string exportJsonText(std::string_view cell, bool shouldReplaceBreakLines)
+{
+    std::string text(cell);
+    if (shouldReplaceBreakLines)
+    {
+        // Replace '\n', going on one byte back since a removal can join a backslash and an 'n'
+        size_t pos = 0;
+        while ((pos = text.find("\\n", pos)) != std::string::npos)
+        {
+            text.replace(pos, 2, "");
+            pos -= pos > 0;
+        }
+    }
+
+    // Escape like quoteJson(), except that the literal \n sequences left are kept as the JSON
+    // line breaks they were written for.
+    static const char hexDigits[] = "0123456789abcdef";
+    std::string escaped;
+    escaped.reserve(text.size() + 8);
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        const char c = text[i];
+        switch (c)
+        {
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '\\':
+            if (i + 1 < text.size() && text[i + 1] == 'n')
+            {
+                escaped += "\\n";
+                i++;
+            }
+            else
+            {
+                escaped += "\\\\";
+            }
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        case '\r':
+            escaped += "\\r";
+            break;
+        case '\t':
+            escaped += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                escaped += "\\u00";
+                escaped += hexDigits[(c >> 4) & 0x0f];
+                escaped += hexDigits[c & 0x0f];
+            }
+            else
+            {
+                escaped += c;
+            }
+        }
+    }
+    return escaped;
+}
+
+/**
+ * Whether a text has characters to escape in a JSON string.
+ */
+static bool needsJsonEscape(std::string_view text)
+{
+    return std::any_of(text.begin(), text.end(), [](unsigned char c)
+    {
+        return c == '"' || c == '\\' || c < 0x20;
+    });
+}
+
+/**
+ * Text of a cell for the formats other than JSON, which take it literally.
+ */
+static std::string plainText(std::string_view cell, bool shouldReplaceBreakLines)
+{
+    std::string text(cell);
+    if (shouldReplaceBreakLines)
+    {
+        size_t pos = 0;
+        while ((pos = text.find("\\n", pos)) != std::string::npos)
+        {
+            text.erase(pos, 2);
+            pos -= pos > 0;
+        }
+    }
+    return text;
+}
+
+/**
+ * Escape a text as the body of a C-style string literal, as used by PO and .strings files.
+ */
+static std::string escapeCString(std::string_view text)
+{
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '\\':
+            escaped += "\\\\";
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        case '\r':
+            escaped += "\\r";
+            break;
+        case '\t':
+            escaped += "\\t";
+            break;
+        default:
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+static void appendUint32(std::string &output, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        output += static_cast<char>((value >> (i * 8)) & 0xff);
+    }
+}
+
+static void storeUint32(std::string &output, size_t offset, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        output[offset + i] = static_cast<char>((value >> (i * 8)) & 0xff);
+    }
+}
+
+namespace
+{
+    /**
+     * i18next JSON, as read by the web clients.
+     */
+    class JsonWriter : public LocaleWriter
+    {
+    public:
+        std::string filename(const std::string &serial) const override
+        {
+            return "common-" + serial + ".json";
+        }
+
+        std::string write(const std::vector<LocaleEntry> &entries, const std::string & /*langName*/, bool shouldReplaceBreakLines) const override
+        {
+            size_t size = 4;
+            for (auto &&entry : entries)
+            {
+                size += entry.key.size() + entry.text.size() + 9;
+            }
+
+            std::string output;
+            output.reserve(size);
+            output += "{\n";
+            for (size_t i = 0; i < entries.size(); i++)
+            {
+                if (i > 0)
+                {
+                    output += ",\n";
+                }
+
+                // Indent
+                output += "  ";
+                // Most keys and cells need no escaping and are appended without a temporary copy.
+                const std::string_view key = entries[i].key;
+                if (needsJsonEscape(key))
+                {
+                    output += quoteJson(key);
+                }
+                else
+                {
+                    output += '"';
+                    output += key;
+                    output += '"';
+                }
+                output += ": \"";
+                const std::string_view text = entries[i].text;
+                if (needsJsonEscape(text))
+                {
+                    output += exportJsonText(text, shouldReplaceBreakLines);
+                }
+                else
+                {
+                    output += text;
+                }
+                output += "\"";
+            }
+            output += entries.empty() ? "}" : "\n}";
+            return output;
+        }
+    };
+
+    /**
+     * gettext PO, with the keys as msgid.
+     */
+    class PoWriter : public LocaleWriter
+    {
+    public:
+        std::string filename(const std::string &serial) const override
+        {
+            return "common-" + serial + ".po";
+        }
+
+        std::string write(const std::vector<LocaleEntry> &entries, const std::string &langName, bool shouldReplaceBreakLines) const override
+        {
+            std::string output;
+            output += "msgid \"\"\n";
+            output += "msgstr \"\"\n";
+            output += "\"Content-Type: text/plain; charset=UTF-8\\n\"\n";
+            output += "\"Language: " + escapeCString(langName) + "\\n\"\n";
+            for (auto &&entry : entries)
+            {
+                output += "\nmsgid \"" + escapeCString(entry.key) + "\"\n";
+                output += "msgstr \"" + escapeCString(plainText(entry.text, shouldReplaceBreakLines)) + "\"\n";
+            }
+            return output;
+        }
+    };
+
+    /**
+     * Compiled gettext MO with the hash table libintl looks the keys up in.
+     */
+    class MoWriter : public LocaleWriter
+    {
+    public:
+        std::string filename(const std::string &serial) const override
+        {
+            return "common-" + serial + ".mo";
+        }
+
+        std::string write(const std::vector<LocaleEntry> &entries, const std::string &langName, bool shouldReplaceBreakLines) const override
+        {
+            // The header is the translation of the empty msgid. Untranslated keys are left out, as
+            // msgfmt does, so gettext falls back to the msgid.
+            std::vector<std::pair<std::string, std::string>> messages;
+            messages.emplace_back("", "Content-Type: text/plain; charset=UTF-8\nLanguage: " + langName + "\n");
+            for (auto &&entry : entries)
+            {
+                if (entry.text.size() > 0)
+                {
+                    messages.emplace_back(std::string(entry.key), plainText(entry.text, shouldReplaceBreakLines));
+                }
+            }
+            // libintl binary searches the original strings when there is no hash table match.
+            std::sort(messages.begin(), messages.end());
+
+            const uint32_t count = static_cast<uint32_t>(messages.size());
+            const uint32_t hashSize = hashTableSize(count);
+            const uint32_t originalsOffset = 28;
+            const uint32_t translationsOffset = originalsOffset + count * 8;
+            const uint32_t hashOffset = translationsOffset + count * 8;
+            uint32_t stringOffset = hashOffset + hashSize * 4;
+
+            std::string output;
+            appendUint32(output, 0x950412de);
+            appendUint32(output, 0);
+            appendUint32(output, count);
+            appendUint32(output, originalsOffset);
+            appendUint32(output, translationsOffset);
+            appendUint32(output, hashSize);
+            appendUint32(output, hashOffset);
+
+            // String descriptors: all originals, then all translations, each NUL-terminated.
+            std::string strings;
+            for (int column = 0; column < 2; column++)
+            {
+                for (auto &&message : messages)
+                {
+                    const std::string &text = column == 0 ? message.first : message.second;
+                    appendUint32(output, static_cast<uint32_t>(text.size()));
+                    appendUint32(output, stringOffset);
+                    strings += text;
+                    strings += '\0';
+                    stringOffset += static_cast<uint32_t>(text.size()) + 1;
+                }
+            }
+
+            // Open addressing with double hashing, storing message index + 1.
+            std::vector<uint32_t> hashTable(hashSize, 0);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const uint32_t hash = hashString(messages[i].first);
+                uint32_t idx = hash % hashSize;
+                const uint32_t increment = 1 + hash % (hashSize - 2);
+                while (hashTable[idx] != 0)
+                {
+                    idx = idx >= hashSize - increment ? idx - (hashSize - increment) : idx + increment;
+                }
+                hashTable[idx] = i + 1;
+            }
+            for (uint32_t slot : hashTable)
+            {
+                appendUint32(output, slot);
+            }
+
+            output += strings;
+            return output;
+        }
+
+    private:
+        /**
+         * hashpjw, as in gettext's hash-string.c.
+         */
+        static uint32_t hashString(const std::string &text)
+        {
+            uint32_t hash = 0;
+            for (unsigned char c : text)
+            {
+                hash = (hash << 4) + c;
+                const uint32_t high = hash & 0xf0000000;
+                if (high != 0)
+                {
+                    hash ^= high >> 24;
+                    hash ^= high;
+                }
+            }
+            return hash;
+        }
+
+        /**
+         * Smallest prime of at least 4/3 of the message count, like msgfmt.
+         */
+        static uint32_t hashTableSize(uint32_t count)
+        {
+            uint32_t size = std::max<uint32_t>(count * 4 / 3, 3) | 1;
+            while (true)
+            {
+                bool isPrime = true;
+                for (uint32_t divisor = 3; divisor * divisor <= size; divisor += 2)
+                {
+                    if (size % divisor == 0)
+                    {
+                        isPrime = false;
+                        break;
+                    }
+                }
+                if (isPrime)
+                {
+                    return size;
+                }
+                size += 2;
+            }
+        }
+    };
+
+    /**
+     * Android string resources.
+     */
+    class AndroidWriter : public LocaleWriter
+    {
+    public:
+        std::string filename(const std::string &serial) const override
+        {
+            return "strings-" + serial + ".xml";
+        }
+
+        std::string write(const std::vector<LocaleEntry> &entries, const std::string & /*langName*/, bool shouldReplaceBreakLines) const override
+        {
+            std::string output;
+            output += "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+            output += "<resources>\n";
+            const std::vector<std::string> names = resourceNames(entries);
+            for (size_t i = 0; i < entries.size(); i++)
+            {
+                output += "    <string name=\"" + names[i] + "\">";
+                output += escapeText(plainText(entries[i].text, shouldReplaceBreakLines));
+                output += "</string>\n";
+            }
+            output += "</resources>\n";
+            return output;
+        }
+
+    private:
+        /**
+         * Resource names only allow letters, digits, '_' and '.', and cannot start with a digit.
+         */
+        static std::string resourceName(std::string_view key)
+        {
+            std::string name;
+            if (key.empty() || (key[0] >= '0' && key[0] <= '9'))
+            {
+                name += '_';
+            }
+            for (char c : key)
+            {
+                const bool isAllowed = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '.';
+                name += isAllowed ? c : '_';
+            }
+            return name;
+        }
+
+        /**
+         * Resource name of each entry. Of the keys giving the same name, e.g. "menu_open",
+         * "menu-open" and "menu.open" as aapt reads '.' like '_', the one needing the fewest
+         * changes keeps it and the others get a suffix "_2", "_3"... in byte order, so the names
+         * do not depend on the order of the rows.
+         */
+        static std::vector<std::string> resourceNames(const std::vector<LocaleEntry> &entries)
+        {
+            std::vector<std::string> names;
+            names.reserve(entries.size());
+            std::map<std::string, std::vector<size_t>> entryIndices;
+            for (size_t i = 0; i < entries.size(); i++)
+            {
+                names.push_back(resourceName(entries[i].key));
+                entryIndices[aaptName(names.back())].push_back(i);
+            }
+
+            std::set<std::string> usedNames;
+            for (auto &&[name, indices] : entryIndices)
+            {
+                usedNames.insert(name);
+            }
+            for (auto &&[name, indices] : entryIndices)
+            {
+                if (indices.size() < 2)
+                {
+                    continue;
+                }
+                const auto changeCount = [&](size_t i)
+                {
+                    return (names[i] != entries[i].key) + (names[i] != aaptName(names[i]));
+                };
+                std::sort(indices.begin(), indices.end(), [&](size_t a, size_t b)
+                {
+                    return std::make_pair(changeCount(a), entries[a].key) < std::make_pair(changeCount(b), entries[b].key);
+                });
+                int suffix = 2;
+                for (size_t i = 1; i < indices.size(); i++)
+                {
+                    std::string suffixedName;
+                    do
+                    {
+                        suffixedName = names[indices[i]] + "_" + std::to_string(suffix++);
+                    } while (!usedNames.insert(aaptName(suffixedName)).second);
+                    names[indices[i]] = std::move(suffixedName);
+                }
+            }
+            return names;
+        }
+
+        /**
+         * Name of the generated R field, which aapt gives '_' in place of '.'.
+         */
+        static std::string aaptName(std::string name)
+        {
+            std::replace(name.begin(), name.end(), '.', '_');
+            return name;
+        }
+
+        static std::string escapeText(std::string_view text)
+        {
+            std::string escaped;
+            escaped.reserve(text.size());
+            for (size_t i = 0; i < text.size(); i++)
+            {
+                const char c = text[i];
+                switch (c)
+                {
+                case '&':
+                    escaped += "&amp;";
+                    break;
+                case '<':
+                    escaped += "&lt;";
+                    break;
+                case '>':
+                    escaped += "&gt;";
+                    break;
+                case '\'':
+                    escaped += "\\'";
+                    break;
+                case '"':
+                    escaped += "\\\"";
+                    break;
+                case '\\':
+                    escaped += "\\\\";
+                    break;
+                case '\n':
+                    escaped += "\\n";
+                    break;
+                case '\t':
+                    escaped += "\\t";
+                    break;
+                case '\r':
+                    // Line breaks are written as \n.
+                    break;
+                case '@':
+                case '?':
+                    // A leading @ or ? would make the text a resource reference.
+                    escaped += i == 0 ? "\\" : "";
+                    escaped += c;
+                    break;
+                default:
+                    escaped += c;
+                }
+            }
+            return escaped;
+        }
+    };
+
+    /**
+     * iOS Localizable.strings, in UTF-8.
+     */
+    class IosWriter : public LocaleWriter
+    {
+    public:
+        std::string filename(const std::string &serial) const override
+        {
+            return "Localizable-" + serial + ".strings";
+        }
+
+        std::string write(const std::vector<LocaleEntry> &entries, const std::string & /*langName*/, bool shouldReplaceBreakLines) const override
+        {
+            std::string output;
+            for (auto &&entry : entries)
+            {
+                output += "\"" + escapeCString(entry.key) + "\" = \"" + escapeCString(plainText(entry.text, shouldReplaceBreakLines)) + "\";\n";
+            }
+            return output;
+        }
+    };
+
+    /**
+     * Binary locale file with a minimal perfect hash over the keys, see binarylocale.hpp.
+     */
+    class BinaryWriter : public LocaleWriter
+    {
+    public:
+        std::string filename(const std::string &serial) const override
+        {
+            return "common-" + serial + ".bin";
+        }
+
+        std::string write(const std::vector<LocaleEntry> &entries, const std::string & /*langName*/, bool shouldReplaceBreakLines) const override
+        {
+            const uint32_t count = static_cast<uint32_t>(entries.size());
+            // Two keys per bucket on average. Larger buckets save little space in the file but
+            // take much longer to place.
+            const uint32_t bucketCount = std::max<uint32_t>(1, count / 2);
+
+            // Entries grouped by bucket, bucket i being bucketEntries[bucketStarts[i]..bucketStarts[i + 1]).
+            std::vector<uint64_t> hashes(count);
+            std::vector<uint32_t> bucketStarts(bucketCount + 1, 0);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                hashes[i] = binaryLocaleHash(entries[i].key);
+                bucketStarts[hashes[i] % bucketCount + 1]++;
+            }
+            std::partial_sum(bucketStarts.begin(), bucketStarts.end(), bucketStarts.begin());
+            std::vector<uint32_t> bucketEntries(count);
+            {
+                std::vector<uint32_t> nextPositions(bucketStarts.begin(), bucketStarts.end() - 1);
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    bucketEntries[nextPositions[hashes[i] % bucketCount]++] = i;
+                }
+            }
+
+            // Place the largest buckets first, while most slots are still free, and give each
+            // bucket the first displacement that sends all its keys to free slots.
+            std::vector<uint32_t> bucketOrder(bucketCount);
+            std::iota(bucketOrder.begin(), bucketOrder.end(), 0);
+            std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&](uint32_t a, uint32_t b)
+            {
+                return bucketStarts[a + 1] - bucketStarts[a] > bucketStarts[b + 1] - bucketStarts[b];
+            });
+            std::vector<uint32_t> displacements(bucketCount, 0);
+            std::vector<uint32_t> slotEntries(count, emptySlot);
+            std::vector<uint32_t> slots;
+            for (uint32_t bucketIdx : bucketOrder)
+            {
+                const uint32_t *bucket = bucketEntries.data() + bucketStarts[bucketIdx];
+                const size_t bucketSize = bucketStarts[bucketIdx + 1] - bucketStarts[bucketIdx];
+                if (bucketSize == 0)
+                {
+                    break;
+                }
+                for (uint32_t displacement = 0; slots.size() < bucketSize; displacement++)
+                {
+                    if (displacement == maxDisplacement)
+                    {
+                        throw std::runtime_error("cannot place the keys of the binary locale file");
+                    }
+                    slots.clear();
+                    for (size_t i = 0; i < bucketSize; i++)
+                    {
+                        const uint32_t slot = binaryLocaleSlot(hashes[bucket[i]], displacement, count);
+                        if (slotEntries[slot] != emptySlot || std::find(slots.begin(), slots.end(), slot) != slots.end())
+                        {
+                            break;
+                        }
+                        slots.push_back(slot);
+                    }
+                    displacements[bucketIdx] = displacement;
+                }
+                for (size_t i = 0; i < bucketSize; i++)
+                {
+                    slotEntries[slots[i]] = bucket[i];
+                }
+                slots.clear();
+            }
+
+            const uint32_t displacementsOffset = static_cast<uint32_t>(BinaryLocale::headerSize);
+            const uint32_t slotsOffset = displacementsOffset + bucketCount * 4;
+            const uint32_t stringsOffset = slotsOffset + count * 16;
+            size_t maxStringsSize = 0;
+            for (auto &&entry : entries)
+            {
+                maxStringsSize += entry.key.size() + entry.text.size() + 2;
+            }
+
+            std::string output;
+            output.reserve(stringsOffset + maxStringsSize);
+            output += "QPPL";
+            appendUint32(output, BinaryLocale::version);
+            appendUint32(output, count);
+            appendUint32(output, bucketCount);
+            appendUint32(output, displacementsOffset);
+            appendUint32(output, slotsOffset);
+            appendUint32(output, stringsOffset);
+            // Strings size, set below.
+            appendUint32(output, 0);
+            for (uint32_t displacement : displacements)
+            {
+                appendUint32(output, displacement);
+            }
+
+            // Strings in slot order, so that a lookup touches nearby pages.
+            output.resize(stringsOffset);
+            size_t slotOffset = slotsOffset;
+            for (uint32_t entryIdx : slotEntries)
+            {
+                std::string_view text = entries[entryIdx].text;
+                std::string replacedText;
+                if (shouldReplaceBreakLines && text.find("\\n") != std::string_view::npos)
+                {
+                    replacedText = plainText(text, shouldReplaceBreakLines);
+                    text = replacedText;
+                }
+                for (std::string_view string : {entries[entryIdx].key, text})
+                {
+                    storeUint32(output, slotOffset, static_cast<uint32_t>(output.size() - stringsOffset));
+                    storeUint32(output, slotOffset + 4, static_cast<uint32_t>(string.size()));
+                    slotOffset += 8;
+                    output += string;
+                    output += '\0';
+                }
+            }
+            storeUint32(output, 28, static_cast<uint32_t>(output.size() - stringsOffset));
+            return output;
+        }
+
+    private:
+        static constexpr uint32_t emptySlot = UINT32_MAX;
+        // Only reached when two keys of a bucket have the same hash.
+        static constexpr uint32_t maxDisplacement = 1 << 24;
+    };
+}
+
+std::unique_ptr<LocaleWriter> makeLocaleWriter(const std::string &format)
+{
+    if (format == "json")
+    {
+        return std::make_unique<JsonWriter>();
+    }
+    else if (format == "po")
+    {
+        return std::make_unique<PoWriter>();
+    }
+    else if (format == "mo")
+    {
+        return std::make_unique<MoWriter>();
+    }
+    else if (format == "android")
+    {
+        return std::make_unique<AndroidWriter>();
+    }
+    else if (format == "ios")
+    {
+        return std::make_unique<IosWriter>();
+    }
+    else if (format == "bin")
+    {
+        return std::make_unique<BinaryWriter>();
+    }
+    throw std::invalid_argument("unknown output format: " + format);
+}
@@ -0,0 +1,191 @@
+#include "odsreader.hpp"
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+
+static Inflater openContent(const ZipArchive &zip)
+{
+    if (!zip.contains("content.xml") || (zip.contains("mimetype") && zip.read("mimetype") != "application/vnd.oasis.opendocument.spreadsheet"))
+    {
+        throw std::runtime_error("not an .ods spreadsheet");
+    }
+    return zip.open("content.xml");
+}
+
+/**
+ * Value of a table:number-rows-repeated or table:number-columns-repeated attribute.
+ */
+static size_t parseRepeatCount(const std::optional<std::string_view> &value)
+{
+    if (!value)
+    {
+        return 1;
+    }
+    size_t count = 0;
+    for (char c : *value)
+    {
+        if (c < '0' || c > '9' || count > 0xffffffff)
+        {
+            throw std::runtime_error("invalid .ods repeat count: " + std::string(*value));
+        }
+        count = count * 10 + static_cast<size_t>(c - '0');
+    }
+    return std::max<size_t>(count, 1);
+}
+
+static bool isCellElement(std::string_view name)
+{
+    return name == "table:table-cell" || name == "table:covered-table-cell";
+}
+
+OdsReader::OdsReader(std::string_view data)
+    : zip(data),
+      contentInflater(openContent(zip)),
+      contentXml([this]()
+                 {
+                     return contentInflater.next();
+                 })
+{
+}
+
+void OdsReader::readCellText(std::string &text)
+{
+    size_t paragraphCount = 0;
+    int paragraphDepth = 0;
+    int annotationDepth = 0;
+    for (XmlReader::Token token = contentXml.next(); token != XmlReader::Token::End; token = contentXml.next())
+    {
+        const std::string_view name = token == XmlReader::Token::Text ? std::string_view() : contentXml.name();
+        if (token == XmlReader::Token::StartElement)
+        {
+            annotationDepth += name == "office:annotation";
+            if (annotationDepth > 0)
+            {
+                continue;
+            }
+            if (name == "text:p" || name == "text:h")
+            {
+                text += paragraphCount++ > 0 ? "\n" : "";
+                paragraphDepth++;
+            }
+            else if (name == "text:s")
+            {
+                text.append(parseRepeatCount(contentXml.attribute("text:c")), ' ');
+            }
+            else if (name == "text:tab")
+            {
+                text += '\t';
+            }
+            else if (name == "text:line-break")
+            {
+                text += '\n';
+            }
+        }
+        else if (token == XmlReader::Token::EndElement)
+        {
+            if (isCellElement(name))
+            {
+                return;
+            }
+            annotationDepth -= name == "office:annotation";
+            paragraphDepth -= annotationDepth == 0 && (name == "text:p" || name == "text:h");
+        }
+        else if (paragraphDepth > 0 && annotationDepth == 0)
+        {
+            appendXmlText(contentXml.text(), text);
+        }
+    }
+    throw std::runtime_error("invalid .ods content: unexpected end of a cell");
+}
+
+bool OdsReader::readTableRow(std::vector<std::string> &cells, size_t &repeatCount)
+{
+    cells.clear();
+    for (XmlReader::Token token = contentXml.next(); !isTableRead && token != XmlReader::Token::End; token = contentXml.next())
+    {
+        if (token == XmlReader::Token::EndElement && contentXml.name() == "table:table")
+        {
+            isTableRead = true;
+        }
+        if (token != XmlReader::Token::StartElement)
+        {
+            continue;
+        }
+        if (contentXml.name() == "table:table")
+        {
+            isInTable = true;
+        }
+        if (!isInTable || contentXml.name() != "table:table-row")
+        {
+            continue;
+        }
+
+        repeatCount = parseRepeatCount(contentXml.attribute("table:number-rows-repeated"));
+        // Blank cells are only added before a cell with text, so that the ones filling the
+        // rest of the row are left out.
+        size_t blankCellCount = 0;
+        std::string text;
+        for (token = contentXml.next(); token != XmlReader::Token::End; token = contentXml.next())
+        {
+            if (token == XmlReader::Token::EndElement && contentXml.name() == "table:table-row")
+            {
+                return true;
+            }
+            if (token != XmlReader::Token::StartElement || !isCellElement(contentXml.name()))
+            {
+                continue;
+            }
+            const size_t cellRepeatCount = parseRepeatCount(contentXml.attribute("table:number-columns-repeated"));
+            text.clear();
+            readCellText(text);
+            if (text.empty())
+            {
+                blankCellCount += cellRepeatCount;
+                continue;
+            }
+            cells.resize(cells.size() + blankCellCount);
+            blankCellCount = 0;
+            cells.insert(cells.end(), cellRepeatCount, text);
+        }
+        throw std::runtime_error("invalid .ods content: unexpected end of a row");
+    }
+    return false;
+}
+
+bool OdsReader::readRow(std::vector<std::string> &cells)
+{
+    // Blank rows are only read before a row with text, like the blank cells of a row.
+    while (rowRepeatCount == 0)
+    {
+        size_t repeatCount = 1;
+        if (!readTableRow(rowCells, repeatCount))
+        {
+            return false;
+        }
+        if (rowCells.empty())
+        {
+            blankRowCount += repeatCount;
+        }
+        else
+        {
+            rowRepeatCount = repeatCount;
+        }
+    }
+
+    cells.clear();
+    if (blankRowCount > 0)
+    {
+        blankRowCount--;
+        return true;
+    }
+    rowRepeatCount--;
+    if (rowRepeatCount == 0)
+    {
+        cells.swap(rowCells);
+    }
+    else
+    {
+        cells = rowCells;
+    }
+    return true;
+}
@@ -0,0 +1,60 @@
+#ifndef ODS_READER_HPP
+#define ODS_READER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "sheetreader.hpp"
+#include "xmlreader.hpp"
+#include "zipreader.hpp"
+
+/**
+ * Reader of the rows of the first table of an OpenDocument .ods spreadsheet, e.g. saved by
+ * LibreOffice.
+ *
+ * The document XML is parsed while it is inflated, so only the current row is held. Cells are
+ * read as displayed, e.g. a number with its format; the paragraphs of a cell are joined with
+ * line breaks and its comments are left out.
+ */
+class OdsReader : public SheetReader
+{
+public:
+    /**
+     * Open a spreadsheet held in memory, which must outlive the reader.
+     *
+     * Throws std::runtime_error when the data is not an .ods spreadsheet.
+     */
+    explicit OdsReader(std::string_view data);
+
+    OdsReader(const OdsReader &) = delete;
+    OdsReader &operator=(const OdsReader &) = delete;
+
+    /**
+     * Replace the cells with those of the next row, up to its last cell with text. Repeated
+     * rows and cells are read as many times as they repeat, but the blank ones LibreOffice
+     * writes up to the end of the table are left out.
+     *
+     * @return false after the last row.
+     */
+    bool readRow(std::vector<std::string> &cells) override;
+
+private:
+    /**
+     * Read the next <table:table-row> element of the first table, and how many times it repeats.
+     */
+    bool readTableRow(std::vector<std::string> &cells, size_t &repeatCount);
+    void readCellText(std::string &text);
+
+    ZipArchive zip;
+    Inflater contentInflater;
+    XmlReader contentXml;
+    bool isInTable = false;
+    bool isTableRead = false;
+
+    // Row read after the blank rows before it, and how many times it is still to be read.
+    std::vector<std::string> rowCells;
+    size_t rowRepeatCount = 0;
+    size_t blankRowCount = 0;
+};
+
+#endif // ODS_READER_HPP
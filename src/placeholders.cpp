@@ -0,0 +1,194 @@
+#include "placeholders.hpp"
+#include <algorithm>
+
+// ICU apostrophe quoting is not interpreted: i18next texts use apostrophes as plain text,
+// e.g. in "l'{{name}}".
+
+static std::string_view trim(std::string_view text)
+{
+    const size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string_view::npos)
+    {
+        return {};
+    }
+    const size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+static void parseMessage(std::string_view text, size_t &i, bool isNested, Placeholders &placeholders);
+
+/**
+ * Parse {{x}} starting at i.
+ */
+static void parseInterpolation(std::string_view text, size_t &i, Placeholders &placeholders)
+{
+    const size_t end = text.find("}}", i + 2);
+    if (end == std::string_view::npos)
+    {
+        placeholders.isMalformed = true;
+        i = text.size();
+        return;
+    }
+
+    std::string_view content = trim(text.substr(i + 2, end - i - 2));
+    if (content.size() > 0 && content[0] == '-')
+    {
+        // Unescaped interpolation.
+        content = trim(content.substr(1));
+    }
+    const std::string_view name = trim(content.substr(0, content.find(',')));
+    placeholders.names.push_back("{{" + std::string(name) + "}}");
+    i = end + 2;
+}
+
+/**
+ * Parse $t(key, options) starting at i.
+ */
+static void parseNesting(std::string_view text, size_t &i, Placeholders &placeholders)
+{
+    size_t end = i + 3;
+    int depth = 1;
+    while (end < text.size() && depth > 0)
+    {
+        depth += text[end] == '(' ? 1 : text[end] == ')' ? -1 : 0;
+        end++;
+    }
+    if (depth > 0)
+    {
+        placeholders.isMalformed = true;
+        i = text.size();
+        return;
+    }
+
+    const std::string_view content = text.substr(i + 3, end - 1 - (i + 3));
+    const std::string_view key = trim(content.substr(0, content.find(',')));
+    placeholders.names.push_back("$t(" + std::string(key) + ")");
+    i = end;
+}
+
+/**
+ * Parse an ICU argument after its opening brace at i.
+ */
+static void parseArgument(std::string_view text, size_t &i, Placeholders &placeholders)
+{
+    const size_t nameEnd = text.find_first_of(",{}", i);
+    if (nameEnd == std::string_view::npos || text[nameEnd] == '{')
+    {
+        // A lone brace.
+        placeholders.isMalformed = true;
+        i = nameEnd == std::string_view::npos ? text.size() : nameEnd;
+        return;
+    }
+
+    const std::string name(trim(text.substr(i, nameEnd - i)));
+    if (text[nameEnd] == '}')
+    {
+        placeholders.names.push_back("{" + name + "}");
+        i = nameEnd + 1;
+        return;
+    }
+
+    const size_t typeEnd = text.find_first_of(",{}", nameEnd + 1);
+    if (typeEnd == std::string_view::npos || text[typeEnd] == '{')
+    {
+        placeholders.isMalformed = true;
+        i = typeEnd == std::string_view::npos ? text.size() : typeEnd;
+        return;
+    }
+
+    const std::string type(trim(text.substr(nameEnd + 1, typeEnd - nameEnd - 1)));
+    placeholders.names.push_back("{" + name + ", " + type + "}");
+    i = typeEnd + 1;
+    if (text[typeEnd] == '}')
+    {
+        return;
+    }
+
+    if (type == "plural" || type == "select" || type == "selectordinal")
+    {
+        // Selectors, each followed by a nested message.
+        while (true)
+        {
+            const size_t messageStart = text.find_first_of("{}", i);
+            if (messageStart == std::string_view::npos)
+            {
+                placeholders.isMalformed = true;
+                i = text.size();
+                return;
+            }
+            i = messageStart + 1;
+            if (text[messageStart] == '}')
+            {
+                return;
+            }
+            parseMessage(text, i, true, placeholders);
+        }
+    }
+
+    // Skip the style of number, date and time arguments.
+    int depth = 1;
+    while (i < text.size() && depth > 0)
+    {
+        depth += text[i] == '{' ? 1 : text[i] == '}' ? -1 : 0;
+        i++;
+    }
+    if (depth > 0)
+    {
+        placeholders.isMalformed = true;
+    }
+}
+
+/**
+ * Parse a message up to its end, or up to and including the closing brace when nested.
+ */
+static void parseMessage(std::string_view text, size_t &i, bool isNested, Placeholders &placeholders)
+{
+    while (i < text.size())
+    {
+        const char c = text[i];
+        if (c == '{' && i + 1 < text.size() && text[i + 1] == '{')
+        {
+            parseInterpolation(text, i, placeholders);
+        }
+        else if (c == '$' && text.compare(i, 3, "$t(") == 0)
+        {
+            parseNesting(text, i, placeholders);
+        }
+        else if (c == '{')
+        {
+            i++;
+            parseArgument(text, i, placeholders);
+        }
+        else if (c == '}' && isNested)
+        {
+            i++;
+            return;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    if (isNested)
+    {
+        placeholders.isMalformed = true;
+    }
+}
+
+Placeholders extractPlaceholders(std::string_view text)
+{
+    Placeholders placeholders;
+    // Most cells have no placeholder at all.
+    if (text.find('{') == std::string_view::npos && text.find("$t(") == std::string_view::npos)
+    {
+        return placeholders;
+    }
+
+    size_t i = 0;
+    parseMessage(text, i, false, placeholders);
+
+    std::sort(placeholders.names.begin(), placeholders.names.end());
+    placeholders.names.erase(std::unique(placeholders.names.begin(), placeholders.names.end()), placeholders.names.end());
+    return placeholders;
+}
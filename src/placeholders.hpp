@@ -0,0 +1,27 @@
+#ifndef PLACEHOLDERS_HPP
+#define PLACEHOLDERS_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Placeholders of a translation, e.g. {{count}}, $t(key), {name} or {count, plural}.
+ */
+struct Placeholders
+{
+    // Sorted and unique.
+    std::vector<std::string> names;
+    // An interpolation, nesting or ICU argument is not closed.
+    bool isMalformed = false;
+};
+
+/**
+ * Tokenize the i18next interpolations ({{x}}, {{- x}}, {{x, format}}), nestings ($t(key))
+ * and ICU arguments ({x}, {x, plural, ...}, {x, select, ...}) of a text, including those
+ * nested in plural and select branches. Plural categories are not compared since they differ
+ * between languages.
+ */
+Placeholders extractPlaceholders(std::string_view text);
+
+#endif // PLACEHOLDERS_HPP
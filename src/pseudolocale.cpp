@@ -0,0 +1,186 @@
+#include "pseudolocale.hpp"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Share of the text length added as padding, in percent: translations are often a third longer
+// than English.
+static const size_t expansionPercent = 35;
+
+static const char *const upperAccents[26] = {
+    "Å", "Ɓ", "Ç", "Đ", "É", "Ƒ", "Ĝ", "Ĥ", "Î", "Ĵ", "Ķ", "Ļ", "Ṁ",
+    "Ñ", "Ö", "Þ", "Ǫ", "Ŕ", "Š", "Ŧ", "Û", "Ṽ", "Ŵ", "Ẋ", "Ý", "Ž",
+};
+static const char *const lowerAccents[26] = {
+    "å", "ƀ", "ç", "ð", "é", "ƒ", "ĝ", "ĥ", "î", "ĵ", "ķ", "ļ", "ɱ",
+    "ñ", "ö", "þ", "ǫ", "ŕ", "š", "ŧ", "û", "ṽ", "ŵ", "ẋ", "ý", "ž",
+};
+
+/**
+ * Output of a byte of message text: up to 4 bytes stored little-endian in bytes.
+ */
+struct ByteReplacement
+{
+    uint32_t bytes = 0;
+    uint8_t size = 1;
+    // Starts a code point, so it counts toward the padding.
+    bool isLeadByte = true;
+    // May start markup or change the brace nesting, handled outside the table.
+    bool isSpecial = false;
+};
+
+static std::array<ByteReplacement, 256> makeReplacements()
+{
+    std::array<ByteReplacement, 256> replacements;
+    for (int byte = 0; byte < 256; byte++)
+    {
+        replacements[byte].bytes = static_cast<uint32_t>(byte);
+        replacements[byte].isLeadByte = (byte & 0xC0) != 0x80;
+    }
+    for (int i = 0; i < 26; i++)
+    {
+        for (auto [letter, accent] : {std::pair<int, std::string_view>('A' + i, upperAccents[i]), std::pair<int, std::string_view>('a' + i, lowerAccents[i])})
+        {
+            ByteReplacement &replacement = replacements[letter];
+            replacement.bytes = 0;
+            for (size_t j = 0; j < accent.size(); j++)
+            {
+                replacement.bytes |= static_cast<uint32_t>(static_cast<unsigned char>(accent[j])) << (8 * j);
+            }
+            replacement.size = static_cast<uint8_t>(accent.size());
+        }
+    }
+    for (char c : std::string_view("{}$<%\\"))
+    {
+        replacements[static_cast<unsigned char>(c)].isSpecial = true;
+    }
+    return replacements;
+}
+
+static const std::array<ByteReplacement, 256> replacements = makeReplacements();
+
+static bool isAsciiLetter(char c)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+static bool isAsciiDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/**
+ * End of the markup starting at i that is copied as is, or i when there is none.
+ */
+static size_t markupEnd(std::string_view text, size_t i)
+{
+    const char c = text[i];
+    if (c == '{' && text.compare(i, 2, "{{") == 0)
+    {
+        const size_t end = text.find("}}", i + 2);
+        return end == std::string_view::npos ? text.size() : end + 2;
+    }
+    if (c == '$' && text.compare(i, 3, "$t(") == 0)
+    {
+        size_t end = i + 3;
+        int depth = 1;
+        while (end < text.size() && depth > 0)
+        {
+            depth += text[end] == '(' ? 1 : text[end] == ')' ? -1 : 0;
+            end++;
+        }
+        return end;
+    }
+    if (c == '<' && i + 1 < text.size() && (isAsciiLetter(text[i + 1]) || isAsciiDigit(text[i + 1]) || text[i + 1] == '/'))
+    {
+        // HTML tags and the numbered tags of react-i18next <Trans>.
+        const size_t end = text.find('>', i + 1);
+        return end == std::string_view::npos ? i : end + 1;
+    }
+    if (c == '%' && i + 1 < text.size())
+    {
+        // printf conversions of the Android and iOS strings, e.g. %d, %1$s or %@.
+        size_t end = i + 1;
+        while (end < text.size() && (isAsciiDigit(text[end]) || text[end] == '$' || text[end] == '.'))
+        {
+            end++;
+        }
+        return end < text.size() && (isAsciiLetter(text[end]) || text[end] == '@') ? end + 1 : i;
+    }
+    if (c == '\\' && i + 1 < text.size())
+    {
+        // The literal \n sequences replaced by the writers.
+        return i + 2;
+    }
+    return i;
+}
+
+void appendPseudoText(std::string_view text, std::string &pseudoText)
+{
+    if (text.empty())
+    {
+        return;
+    }
+
+    // Written through a pointer into room for the longest output, 3 bytes per accented letter,
+    // then cut to size.
+    const size_t oldSize = pseudoText.size();
+    pseudoText.resize(oldSize + text.size() * 3 + (text.size() * expansionPercent + 99) / 100 + 8);
+    char *out = pseudoText.data() + oldSize;
+    *out++ = '[';
+
+    size_t codePointCount = 0;
+    // Whether each open ICU brace starts a branch message, which is transformed, rather than an
+    // argument, whose name, type and selectors are copied as is.
+    std::vector<bool> isMessageBraces;
+    bool isInMessage = true;
+    size_t i = 0;
+    while (i < text.size())
+    {
+        const ByteReplacement &replacement = replacements[static_cast<unsigned char>(text[i])];
+        if (isInMessage && !replacement.isSpecial)
+        {
+            std::memcpy(out, &replacement.bytes, 4);
+            out += replacement.size;
+            codePointCount += replacement.isLeadByte;
+            i++;
+            continue;
+        }
+
+        const char c = text[i];
+        if (isInMessage)
+        {
+            const size_t end = markupEnd(text, i);
+            if (end > i)
+            {
+                std::memcpy(out, text.data() + i, end - i);
+                out += end - i;
+                i = end;
+                continue;
+            }
+        }
+        if (c == '{')
+        {
+            isMessageBraces.push_back(!isInMessage);
+        }
+        else if (c == '}' && !isMessageBraces.empty())
+        {
+            isMessageBraces.pop_back();
+        }
+        isInMessage = isMessageBraces.empty() || isMessageBraces.back();
+        codePointCount += isInMessage && c != '{' && c != '}';
+        *out++ = c;
+        i++;
+    }
+
+    const size_t padding = (codePointCount * expansionPercent + 99) / 100;
+    if (padding > 0)
+    {
+        *out++ = ' ';
+        std::memset(out, '~', padding);
+        out += padding;
+    }
+    *out++ = ']';
+    pseudoText.resize(static_cast<size_t>(out - pseudoText.data()));
+}
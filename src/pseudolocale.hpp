@@ -0,0 +1,18 @@
+#ifndef PSEUDO_LOCALE_HPP
+#define PSEUDO_LOCALE_HPP
+
+#include <string>
+#include <string_view>
+
+/**
+ * Append the pseudo-localized text, e.g. "Save {{name}}" becomes "[Šåṽé {{name}} ~~~]", to
+ * pseudoText: ASCII letters are accented, the text is padded by about a third and bracketed, so
+ * that truncated or hard-coded strings stand out in the UI.
+ *
+ * Interpolations, nestings, ICU arguments (the messages of plural and select branches are
+ * transformed), printf conversions, tags and escape sequences are copied as is. Empty texts stay
+ * empty.
+ */
+void appendPseudoText(std::string_view text, std::string &pseudoText);
+
+#endif // PSEUDO_LOCALE_HPP
@@ -0,0 +1,225 @@
+#include "searchindex.hpp"
+#include <algorithm>
+#include <future>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include "rapidcsv.h"
+#include "json.hpp"
+
+static const int bucketBits = 20;
+static const size_t bucketCount = size_t(1) << bucketBits;
+// Keys per chunk indexed on its own thread, at least.
+static const size_t chunkMinSize = 4 * 1024;
+
+static char foldCase(char c)
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+static uint32_t trigramBucket(char a, char b, char c)
+{
+    const uint32_t trigram = static_cast<unsigned char>(foldCase(a)) |
+                             static_cast<unsigned char>(foldCase(b)) << 8 |
+                             static_cast<unsigned char>(foldCase(c)) << 16;
+    return (trigram * 0x9e3779b1) >> (32 - bucketBits);
+}
+
+static void appendTrigramBuckets(std::string_view text, std::vector<uint32_t> &buckets)
+{
+    for (size_t i = 0; i + 2 < text.size(); i++)
+    {
+        buckets.push_back(trigramBucket(text[i], text[i + 1], text[i + 2]));
+    }
+}
+
+static bool containsIgnoringCase(std::string_view text, std::string_view query)
+{
+    return std::search(text.begin(), text.end(), query.begin(), query.end(), [](char a, char b)
+    {
+        return foldCase(a) == foldCase(b);
+    }) != text.end();
+}
+
+SearchIndex::SearchIndex(const rapidcsv::Document &doc, const KeyIndex &keyIndex, const std::vector<std::string> &langNames)
+    : doc(doc), keyIndex(keyIndex), langNames(langNames)
+{
+    for (auto &&langName : langNames)
+    {
+        const int columnIdx = doc.GetColumnIdx(langName);
+        if (columnIdx < 0)
+        {
+            throw std::out_of_range("column not found: " + langName);
+        }
+        columnIdxs.push_back(static_cast<size_t>(columnIdx));
+    }
+
+    // Each chunk of keys counts its keys per bucket, then adds them to its own part of every
+    // posting list, which keeps the lists in key order without merging.
+    const size_t threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    const size_t chunkCount = std::max<size_t>(std::min(threadCount, keyIndex.keys.size() / chunkMinSize), 1);
+    std::vector<size_t> bounds;
+    for (size_t i = 0; i <= chunkCount; i++)
+    {
+        bounds.push_back(keyIndex.keys.size() * i / chunkCount);
+    }
+
+    std::vector<std::vector<uint32_t>> chunkPositions(chunkCount, std::vector<uint32_t>(bucketCount, 0));
+    for (bool isFilling : {false, true})
+    {
+        std::vector<std::future<void>> futures;
+        for (size_t i = 0; i < chunkCount; i++)
+        {
+            futures.push_back(std::async(std::launch::async, [&, i, isFilling]()
+            {
+                addKeys(bounds[i], bounds[i + 1], chunkPositions[i], isFilling);
+            }));
+        }
+        for (auto &&future : futures)
+        {
+            future.get();
+        }
+
+        if (!isFilling)
+        {
+            // Turn the counts into the first position of each chunk in each bucket.
+            bucketStarts.assign(bucketCount + 1, 0);
+            uint32_t position = 0;
+            for (size_t bucket = 0; bucket < bucketCount; bucket++)
+            {
+                bucketStarts[bucket] = position;
+                for (size_t i = 0; i < chunkCount; i++)
+                {
+                    const uint32_t count = chunkPositions[i][bucket];
+                    chunkPositions[i][bucket] = position;
+                    position += count;
+                }
+            }
+            bucketStarts[bucketCount] = position;
+            postings.resize(position);
+        }
+    }
+}
+
+void SearchIndex::addKeys(size_t begin, size_t end, std::vector<uint32_t> &positions, bool isFilling)
+{
+    // The last text added to each bucket, so that a text is added once per bucket.
+    std::vector<uint32_t> lastTextIds(bucketCount, UINT32_MAX);
+    const size_t columnCount = columnIdxs.size() + 1;
+    for (size_t i = begin; i < end; i++)
+    {
+        for (size_t column = 0; column < columnCount; column++)
+        {
+            const uint32_t textId = static_cast<uint32_t>(i * columnCount + column);
+            const std::string_view cellText = text(i, column);
+            for (size_t j = 0; j + 2 < cellText.size(); j++)
+            {
+                const uint32_t bucket = trigramBucket(cellText[j], cellText[j + 1], cellText[j + 2]);
+                if (lastTextIds[bucket] == textId)
+                {
+                    continue;
+                }
+                lastTextIds[bucket] = textId;
+                if (isFilling)
+                {
+                    postings[positions[bucket]++] = textId;
+                }
+                else
+                {
+                    positions[bucket]++;
+                }
+            }
+        }
+    }
+}
+
+std::vector<SearchHit> SearchIndex::search(std::string_view query, size_t maxHitCount) const
+{
+    std::vector<SearchHit> hits;
+    if (query.empty())
+    {
+        return hits;
+    }
+
+    // Texts holding every trigram of the query, from the shortest posting list on. Queries
+    // shorter than a trigram check every text.
+    const size_t columnCount = columnIdxs.size() + 1;
+    std::vector<uint32_t> candidates;
+    if (query.size() < 3)
+    {
+        candidates.resize(keyIndex.keys.size() * columnCount);
+        std::iota(candidates.begin(), candidates.end(), 0);
+    }
+    else
+    {
+        std::vector<uint32_t> buckets;
+        appendTrigramBuckets(query, buckets);
+        std::sort(buckets.begin(), buckets.end());
+        buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+        std::sort(buckets.begin(), buckets.end(), [&](uint32_t a, uint32_t b)
+        {
+            return bucketStarts[a + 1] - bucketStarts[a] < bucketStarts[b + 1] - bucketStarts[b];
+        });
+
+        candidates.assign(postings.begin() + bucketStarts[buckets[0]], postings.begin() + bucketStarts[buckets[0] + 1]);
+        std::vector<uint32_t> intersection;
+        for (size_t i = 1; i < buckets.size() && candidates.size() > 0; i++)
+        {
+            intersection.clear();
+            std::set_intersection(candidates.begin(), candidates.end(),
+                                  postings.begin() + bucketStarts[buckets[i]], postings.begin() + bucketStarts[buckets[i] + 1],
+                                  std::back_inserter(intersection));
+            candidates.swap(intersection);
+        }
+    }
+
+    // The buckets only narrow the texts down, they are checked for the whole query.
+    for (uint32_t textId : candidates)
+    {
+        const size_t keyPosition = textId / columnCount;
+        const size_t column = textId % columnCount;
+        const std::string_view cellText = text(keyPosition, column);
+        if (!containsIgnoringCase(cellText, query))
+        {
+            continue;
+        }
+        if (hits.size() == maxHitCount)
+        {
+            break;
+        }
+
+        SearchHit hit;
+        hit.key = keyIndex.keys[keyPosition];
+        hit.row = keyIndex.rowIndices[keyPosition];
+        hit.langName = column == 0 ? "" : langNames[column - 1];
+        hit.text = cellText;
+        hits.push_back(std::move(hit));
+    }
+    return hits;
+}
+
+std::string_view SearchIndex::text(size_t keyPosition, size_t column) const
+{
+    if (column == 0)
+    {
+        return keyIndex.keys[keyPosition];
+    }
+    return doc.GetCell<std::string_view>(columnIdxs[column - 1], keyIndex.rowIndices[keyPosition]);
+}
+
+std::string searchHitsToJson(const std::vector<SearchHit> &hits)
+{
+    std::string json = "[";
+    for (size_t i = 0; i < hits.size(); i++)
+    {
+        json += i > 0 ? ",\n  " : "\n  ";
+        json += "{\"key\": " + quoteJson(hits[i].key) + ", \"row\": " + std::to_string(hits[i].row);
+        if (hits[i].langName.size() > 0)
+        {
+            json += ", \"language\": " + quoteJson(hits[i].langName);
+        }
+        json += ", \"text\": " + quoteJson(hits[i].text) + "}";
+    }
+    json += hits.empty() ? "]" : "\n]";
+    return json;
+}
@@ -0,0 +1,66 @@
+#ifndef SEARCH_INDEX_HPP
+#define SEARCH_INDEX_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "convert.hpp"
+
+/**
+ * A cell or key containing the searched text.
+ */
+struct SearchHit
+{
+    std::string key;
+    // Document row, or sheet row (1-based) from TranslationService.
+    size_t row = 0;
+    // Empty when the key itself matched.
+    std::string langName;
+    std::string text;
+};
+
+/**
+ * Trigram index over the keys and the language cells of a sheet, answering substring queries
+ * without scanning every cell. Matching ignores ASCII case.
+ *
+ * The index points into doc and keyIndex, which must outlive it.
+ */
+class SearchIndex
+{
+public:
+    SearchIndex(const rapidcsv::Document &doc, const KeyIndex &keyIndex, const std::vector<std::string> &langNames);
+
+    /**
+     * Keys and cells containing query, in key order, at most maxHitCount of them.
+     */
+    std::vector<SearchHit> search(std::string_view query, size_t maxHitCount) const;
+
+private:
+    /**
+     * Count the keys in [begin, end) per bucket into positions, or with isFilling, write them
+     * to the postings at positions.
+     */
+    void addKeys(size_t begin, size_t end, std::vector<uint32_t> &positions, bool isFilling);
+    /**
+     * The key at column 0, the cells of the languages after it.
+     */
+    std::string_view text(size_t keyPosition, size_t column) const;
+
+    const rapidcsv::Document &doc;
+    const KeyIndex &keyIndex;
+    std::vector<std::string> langNames;
+    std::vector<size_t> columnIdxs;
+    // Texts, numbered keyPosition * (language count + 1) + column, containing a trigram of each
+    // bucket, in increasing order: bucket i is postings[bucketStarts[i]..bucketStarts[i + 1]).
+    // Trigrams are hashed into the buckets, so a list may also hold texts without the trigram.
+    std::vector<uint32_t> bucketStarts;
+    std::vector<uint32_t> postings;
+};
+
+/**
+ * Serialize search hits as a JSON array.
+ */
+std::string searchHitsToJson(const std::vector<SearchHit> &hits);
+
+#endif // SEARCH_INDEX_HPP
@@ -0,0 +1,130 @@
+#include "service.hpp"
+#include <stdexcept>
+#include "rapidcsv.h"
+#include "json.hpp"
+
+TranslationService::TranslationService(const ConvertOptions &options) : options(options)
+{
+}
+
+TranslationService::~TranslationService() = default;
+
+bool TranslationService::reload()
+{
+    const std::filesystem::path path = std::filesystem::u8path(options.translationFilename);
+    const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path);
+    const uintmax_t size = std::filesystem::file_size(path);
+    if (doc != nullptr && writeTime == lastWriteTime && size == fileSize)
+    {
+        return false;
+    }
+
+    // Parsed aside so that a failed load keeps serving the previous version.
+    auto newDoc = std::make_unique<rapidcsv::Document>(readCvs(options.translationFilename, options.columnNameIndex, options.rowNameIndex, options.dialect));
+    sanitizeUtf8(*newDoc, options.langNames, options.shouldRepairInvalidUtf8, options.shouldNormalizeNfc);
+    KeyIndex newKeys = indexKeys(*newDoc);
+    if (options.shouldSortKeys)
+    {
+        sortKeys(newKeys);
+    }
+
+    searchIndex.reset();
+    doc = std::move(newDoc);
+    keys = std::move(newKeys);
+    keyPositions.clear();
+    keyPositions.reserve(keys.keys.size());
+    for (size_t i = 0; i < keys.keys.size(); i++)
+    {
+        keyPositions.emplace(keys.keys[i], i);
+    }
+    renderedFiles.clear();
+    lastWriteTime = writeTime;
+    fileSize = size;
+    return true;
+}
+
+bool TranslationService::isLoaded() const
+{
+    return doc != nullptr;
+}
+
+const std::string &TranslationService::render(const std::string &langName, const std::string &format)
+{
+    if (doc == nullptr)
+    {
+        throw std::runtime_error("translation file not loaded");
+    }
+
+    const std::pair<std::string, std::string> cacheKey(langName, format);
+    auto it = renderedFiles.find(cacheKey);
+    if (it == renderedFiles.end())
+    {
+        const std::unique_ptr<LocaleWriter> writer = makeLocaleWriter(format);
+        LocaleFile coverage;
+        const std::vector<LocaleEntry> entries = collectEntries(*doc, keys, langName, options.missingTranslation, options.fallbackLangNames, coverage);
+        it = renderedFiles.emplace(cacheKey, writer->write(entries, langName, options.shouldReplaceBreakLines)).first;
+    }
+    return it->second;
+}
+
+std::optional<std::string> TranslationService::lookup(const std::string &key) const
+{
+    const auto it = keyPositions.find(key);
+    if (doc == nullptr || it == keyPositions.end())
+    {
+        return std::nullopt;
+    }
+
+    // Document rows start after the column names row.
+    const size_t rowIdx = keys.rowIndices[it->second];
+    std::string json = "{\"key\": " + quoteJson(key) + ", \"row\": " + std::to_string(rowIdx + options.columnNameIndex + 2) + ", \"translations\": {";
+    for (size_t i = 0; i < options.langNames.size(); i++)
+    {
+        const int columnIdx = doc->GetColumnIdx(options.langNames[i]);
+        const std::string_view cell = columnIdx < 0 ? std::string_view() : doc->GetCell<std::string_view>(static_cast<size_t>(columnIdx), rowIdx);
+        json += i > 0 ? ", " : "";
+        json += quoteJson(options.langNames[i]) + ": " + quoteJson(cell);
+    }
+    json += "}}";
+    return json;
+}
+
+std::string TranslationService::exportNamespace(const std::string &namespaceName, const std::string &langName) const
+{
+    if (doc == nullptr)
+    {
+        throw std::runtime_error("translation file not loaded");
+    }
+
+    LocaleFile coverage;
+    std::vector<LocaleEntry> entries = collectEntries(*doc, keys, langName, options.missingTranslation, options.fallbackLangNames, coverage);
+    const std::string prefix = namespaceName + ".";
+    std::vector<LocaleEntry> namespaceEntries;
+    for (auto &&entry : entries)
+    {
+        if (entry.key.size() > prefix.size() && entry.key.compare(0, prefix.size(), prefix) == 0)
+        {
+            namespaceEntries.push_back({entry.key.substr(prefix.size()), entry.text});
+        }
+    }
+    return makeLocaleWriter("json")->write(namespaceEntries, langName, options.shouldReplaceBreakLines);
+}
+
+std::vector<SearchHit> TranslationService::search(const std::string &query, size_t maxHitCount)
+{
+    if (doc == nullptr)
+    {
+        throw std::runtime_error("translation file not loaded");
+    }
+
+    if (searchIndex == nullptr)
+    {
+        searchIndex = std::make_unique<SearchIndex>(*doc, keys, options.langNames);
+    }
+    std::vector<SearchHit> hits = searchIndex->search(query, maxHitCount);
+    for (auto &&hit : hits)
+    {
+        hit.row += static_cast<size_t>(options.columnNameIndex) + 2;
+    }
+    return hits;
+}
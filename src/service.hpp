@@ -0,0 +1,81 @@
+#ifndef SERVICE_HPP
+#define SERVICE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include "convert.hpp"
+#include "searchindex.hpp"
+
+/**
+ * Translation file parsed once and kept in memory, for the daemon mode of the CLI.
+ *
+ * Each request first checks the modification time and size of the file and parses it again
+ * only when they changed. Rendered locale files are cached until then. Not thread-safe.
+ */
+class TranslationService
+{
+public:
+    explicit TranslationService(const ConvertOptions &options);
+    ~TranslationService();
+
+    /**
+     * Parse the translation file if it changed since the last load.
+     *
+     * When the new version cannot be read, e.g. while an editor is still writing it, the
+     * previous one is kept and the error is thrown.
+     *
+     * @return Whether the file was parsed.
+     */
+    bool reload();
+
+    /**
+     * Whether a version of the translation file was parsed.
+     */
+    bool isLoaded() const;
+
+    /**
+     * Locale file of a language in one of the output formats of makeLocaleWriter().
+     *
+     * Throws std::out_of_range for an unknown language and std::invalid_argument for an
+     * unknown format.
+     */
+    const std::string &render(const std::string &langName, const std::string &format);
+
+    /**
+     * Text of a key in every converted language as a JSON object, nothing for an unknown key.
+     */
+    std::optional<std::string> lookup(const std::string &key) const;
+
+    /**
+     * i18next JSON of the keys of a language under a namespace, i.e. the keys starting with
+     * "<namespaceName>.", without that prefix.
+     */
+    std::string exportNamespace(const std::string &namespaceName, const std::string &langName) const;
+
+    /**
+     * Keys and cells of the converted languages containing query, ignoring ASCII case, with
+     * sheet rows. The search index is built on the first search after a load.
+     */
+    std::vector<SearchHit> search(const std::string &query, size_t maxHitCount);
+
+private:
+    ConvertOptions options;
+    std::unique_ptr<rapidcsv::Document> doc;
+    KeyIndex keys;
+    // Position of each key in keys.
+    std::unordered_map<std::string_view, size_t> keyPositions;
+    std::filesystem::file_time_type lastWriteTime;
+    uintmax_t fileSize = 0;
+    std::unique_ptr<SearchIndex> searchIndex;
+    // Rendered locale files by language and format.
+    std::map<std::pair<std::string, std::string>, std::string> renderedFiles;
+};
+
+#endif // SERVICE_HPP
@@ -0,0 +1,200 @@
+#include "sheetreader.hpp"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include "json.hpp"
+#include "odsreader.hpp"
+#include "xlsxreader.hpp"
+
+SheetFormat sheetFormatOf(const std::string &filename)
+{
+    std::string extension = std::filesystem::u8path(filename).extension().u8string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c)
+    {
+        return static_cast<char>(std::tolower(c));
+    });
+    if (extension == ".tsv")
+    {
+        return SheetFormat::Tsv;
+    }
+    if (extension == ".xlsx")
+    {
+        return SheetFormat::Xlsx;
+    }
+    if (extension == ".ods")
+    {
+        return SheetFormat::Ods;
+    }
+    if (extension == ".jsonl" || extension == ".ndjson")
+    {
+        return SheetFormat::JsonLines;
+    }
+    return SheetFormat::Csv;
+}
+
+std::string sheetFormatName(SheetFormat format)
+{
+    switch (format)
+    {
+    case SheetFormat::Csv:
+        return "csv";
+    case SheetFormat::Tsv:
+        return "tsv";
+    case SheetFormat::Xlsx:
+        return "xlsx";
+    case SheetFormat::Ods:
+        return "ods";
+    case SheetFormat::JsonLines:
+        return "jsonl";
+    }
+    return "";
+}
+
+/**
+ * Skip the UTF-8 byte order mark of a text file.
+ */
+static std::string_view skipBom(std::string_view data)
+{
+    return data.substr(0, 3) == "\xef\xbb\xbf" ? data.substr(3) : data;
+}
+
+namespace
+{
+    class JsonLinesReader : public SheetReader
+    {
+    public:
+        JsonLinesReader(std::string_view data, int columnNameIndex, int rowNameIndex)
+            : data(skipBom(data)), columnNameIndex(columnNameIndex), keyColumn(static_cast<size_t>(std::max(rowNameIndex, 0)))
+        {
+        }
+
+        bool readRow(std::vector<std::string> &cells) override
+        {
+            cells.clear();
+            if (rowCount < columnNameIndex)
+            {
+                rowCount++;
+                return true;
+            }
+            if (rowCount == columnNameIndex)
+            {
+                // The fields are those of the first line.
+                rowCount++;
+                isLineRead = readLine();
+                cells.resize(keyColumn);
+                cells.push_back("key");
+                cells.insert(cells.end(), fieldNames.begin(), fieldNames.end());
+                return true;
+            }
+
+            if (!isLineRead && !readLine())
+            {
+                return false;
+            }
+            isLineRead = false;
+            rowCount++;
+
+            cells.resize(keyColumn + 1 + fieldNames.size());
+            bool hasKey = false;
+            for (auto &&[name, value] : entries)
+            {
+                if (name == "key")
+                {
+                    cells[keyColumn] = std::move(value);
+                    hasKey = true;
+                    continue;
+                }
+                const auto it = fieldColumns.find(name);
+                if (it == fieldColumns.end())
+                {
+                    throw std::runtime_error("line " + std::to_string(lineNumber) + ": field \"" + name + "\" is not on the first line");
+                }
+                cells[keyColumn + 1 + it->second] = std::move(value);
+            }
+            if (!hasKey)
+            {
+                throw std::runtime_error("line " + std::to_string(lineNumber) + ": no \"key\" field");
+            }
+            return true;
+        }
+
+    private:
+        /**
+         * Parse the next non-blank line into entries, taking the fields from the first one.
+         */
+        bool readLine()
+        {
+            entries.clear();
+            while (pos < data.size())
+            {
+                const size_t lineEnd = std::min(data.find('\n', pos), data.size());
+                const std::string_view line = data.substr(pos, lineEnd - pos);
+                pos = lineEnd + 1;
+                lineNumber++;
+                if (line.find_first_not_of(" \t\r") == std::string_view::npos)
+                {
+                    continue;
+                }
+
+                try
+                {
+                    parseJsonObject(line, [&](std::string &&name, std::string &&value)
+                    {
+                        entries.emplace_back(std::move(name), std::move(value));
+                    });
+                }
+                catch (const std::runtime_error &error)
+                {
+                    throw std::runtime_error("line " + std::to_string(lineNumber) + ": " + error.what());
+                }
+                if (!areFieldsRead)
+                {
+                    areFieldsRead = true;
+                    for (auto &&entry : entries)
+                    {
+                        if (entry.first != "key" && fieldColumns.emplace(entry.first, fieldNames.size()).second)
+                        {
+                            fieldNames.push_back(entry.first);
+                        }
+                    }
+                }
+                return true;
+            }
+            return false;
+        }
+
+        std::string_view data;
+        size_t pos = 0;
+        size_t lineNumber = 0;
+        int columnNameIndex;
+        size_t keyColumn;
+        int rowCount = 0;
+        bool areFieldsRead = false;
+        // Fields of the first line but "key", in their order, and their position among them.
+        std::vector<std::string> fieldNames;
+        std::unordered_map<std::string, size_t> fieldColumns;
+        // Line read to take the fields from, before it is returned as a row.
+        bool isLineRead = false;
+        std::vector<std::pair<std::string, std::string>> entries;
+    };
+}
+
+std::unique_ptr<SheetReader> makeSheetReader(SheetFormat format, std::string_view data, int columnNameIndex, int rowNameIndex)
+{
+    switch (format)
+    {
+    case SheetFormat::Xlsx:
+        return std::make_unique<XlsxReader>(data);
+    case SheetFormat::Ods:
+        return std::make_unique<OdsReader>(data);
+    case SheetFormat::JsonLines:
+        return std::make_unique<JsonLinesReader>(data, columnNameIndex, rowNameIndex);
+    case SheetFormat::Csv:
+    case SheetFormat::Tsv:
+        break;
+    }
+    throw std::runtime_error("CSV and TSV files are read by rapidcsv::Document");
+}
@@ -0,0 +1,64 @@
+#ifndef SHEET_READER_HPP
+#define SHEET_READER_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * File format of a translation file, told by its extension.
+ */
+enum class SheetFormat
+{
+    // Anything else, see CsvDialect.
+    Csv,
+    // .tsv: CSV separated by tabs, with double quotes around the cells holding tabs, quotes or
+    // line breaks.
+    Tsv,
+    // .xlsx: first worksheet of an Excel workbook, see XlsxReader.
+    Xlsx,
+    // .ods: first table of an OpenDocument spreadsheet, see OdsReader.
+    Ods,
+    // .jsonl or .ndjson: one JSON object per line, e.g. exported by a TMS.
+    JsonLines,
+};
+
+SheetFormat sheetFormatOf(const std::string &filename);
+
+/**
+ * Name of a format as shown to users, e.g. "xlsx".
+ */
+std::string sheetFormatName(SheetFormat format);
+
+/**
+ * Source of the rows of a translation file, read one by one as the file is decoded so that the
+ * file is never held in another form than its own.
+ */
+class SheetReader
+{
+public:
+    virtual ~SheetReader() = default;
+
+    /**
+     * Replace the cells with those of the next row.
+     *
+     * Throws std::runtime_error when the file is malformed.
+     *
+     * @return false after the last row.
+     */
+    virtual bool readRow(std::vector<std::string> &cells) = 0;
+};
+
+/**
+ * Reader of a translation file of any format but CSV and TSV, held in memory, which must
+ * outlive the reader. CSV and TSV files are read by the parser of rapidcsv, which splits them
+ * over all cores.
+ *
+ * A JSON-lines file has a header row at row columnNameIndex with the field names of its first
+ * line, the "key" field at column rowNameIndex followed by the others. Its values are strings,
+ * nested objects become fields named with '.', as in parseJsonObject().
+ */
+std::unique_ptr<SheetReader> makeSheetReader(SheetFormat format, std::string_view data, int columnNameIndex, int rowNameIndex);
+
+#endif // SHEET_READER_HPP
@@ -0,0 +1,90 @@
+#include "stats.hpp"
+#include <atomic>
+#include <sstream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "json.hpp"
+
+static std::atomic<size_t> allocations{0};
+
+void countAllocation()
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t allocationCount()
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+bool areAllocationsCounted()
+{
+    return allocationCount() > 0;
+}
+
+size_t peakMemoryBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+std::string statsToJson(const ConvertStats &stats)
+{
+    std::ostringstream output;
+    output << "{\n";
+    output << "  \"stages\": [";
+    for (size_t i = 0; i < stats.stages.size(); i++)
+    {
+        const StageStats &stage = stats.stages[i];
+        output << (i > 0 ? ",\n" : "\n");
+        output << "    {\"name\": " << quoteJson(stage.name)
+               << ", \"milliseconds\": " << stage.milliseconds;
+        if (stats.areAllocationsCounted)
+        {
+            output << ", \"allocations\": " << stage.allocations;
+        }
+        output << "}";
+    }
+    output << "\n  ],\n";
+    output << "  \"totalMilliseconds\": " << stats.totalMilliseconds << ",\n";
+    output << "  \"rowCount\": " << stats.rowCount << ",\n";
+    output << "  \"cellCount\": " << stats.cellCount << ",\n";
+    output << "  \"inputBytes\": " << stats.inputBytes << ",\n";
+    output << "  \"outputBytes\": " << stats.outputBytes << ",\n";
+    if (stats.areAllocationsCounted)
+    {
+        output << "  \"allocations\": " << stats.allocations << ",\n";
+    }
+    output << "  \"peakMemoryBytes\": " << stats.peakMemoryBytes << "\n";
+    output << "}";
+    return output.str();
+}
@@ -0,0 +1,77 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * Count an allocation. Called by the replacement operator new of the processes that count
+ * their allocations, e.g. the bench, so that the others keep the default allocator.
+ */
+void countAllocation();
+
+/**
+ * Number of allocations counted so far in the process, 0 when they are not counted.
+ */
+size_t allocationCount();
+
+/**
+ * Whether the process counts its allocations, i.e. any was counted.
+ */
+bool areAllocationsCounted();
+
+/**
+ * Peak resident memory of the process in bytes, 0 when unknown.
+ */
+size_t peakMemoryBytes();
+
+struct StageStats
+{
+    std::string name;
+    double milliseconds = 0;
+    size_t allocations = 0;
+};
+
+/**
+ * Timings and counters of a conversion.
+ */
+struct ConvertStats
+{
+    // Stages in the order they ran, e.g. read, parse, validate, key index, placeholders, write.
+    std::vector<StageStats> stages;
+    double totalMilliseconds = 0;
+    size_t rowCount = 0;
+    size_t cellCount = 0;
+    size_t inputBytes = 0;
+    size_t outputBytes = 0;
+    // Allocation counts are only set when the process counts them, see countAllocation().
+    bool areAllocationsCounted = false;
+    size_t allocations = 0;
+    size_t peakMemoryBytes = 0;
+};
+
+/**
+ * Run a stage and append its wall time and allocation count to the stats.
+ */
+template <typename Stage>
+void measureStage(ConvertStats &stats, const std::string &name, Stage &&stage)
+{
+    const size_t allocationsBefore = allocationCount();
+    const auto start = std::chrono::steady_clock::now();
+    stage();
+    const auto end = std::chrono::steady_clock::now();
+
+    StageStats stageStats;
+    stageStats.name = name;
+    stageStats.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+    stageStats.allocations = allocationCount() - allocationsBefore;
+    stats.stages.push_back(stageStats);
+}
+
+/**
+ * Serialize the stats as a JSON object.
+ */
+std::string statsToJson(const ConvertStats &stats);
+
+#endif // STATS_HPP
@@ -0,0 +1,184 @@
+#include "utf8.hpp"
+#include <cstdint>
+#include <QString>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define UTF8_SSE2
+#endif
+
+/**
+ * Decode one code point.
+ *
+ * @return Length of the sequence, or the negated length of its maximal ill-formed prefix.
+ */
+static int decodeUtf8(const unsigned char *p, size_t size, uint32_t &codePoint)
+{
+    const unsigned char lead = p[0];
+    int count;
+    unsigned char low = 0x80;
+    unsigned char high = 0xbf;
+    if (lead < 0x80)
+    {
+        codePoint = lead;
+        return 1;
+    }
+    else if (lead >= 0xc2 && lead <= 0xdf)
+    {
+        count = 1;
+        codePoint = lead & 0x1f;
+    }
+    else if (lead >= 0xe0 && lead <= 0xef)
+    {
+        count = 2;
+        codePoint = lead & 0x0f;
+        // Reject overlong forms and surrogates.
+        low = lead == 0xe0 ? 0xa0 : 0x80;
+        high = lead == 0xed ? 0x9f : 0xbf;
+    }
+    else if (lead >= 0xf0 && lead <= 0xf4)
+    {
+        count = 3;
+        codePoint = lead & 0x07;
+        // Reject overlong forms and code points above U+10FFFF.
+        low = lead == 0xf0 ? 0x90 : 0x80;
+        high = lead == 0xf4 ? 0x8f : 0xbf;
+    }
+    else
+    {
+        return -1;
+    }
+
+    for (int i = 1; i <= count; i++)
+    {
+        if (static_cast<size_t>(i) >= size || p[i] < low || p[i] > high)
+        {
+            return -i;
+        }
+        codePoint = (codePoint << 6) | (p[i] & 0x3f);
+        low = 0x80;
+        high = 0xbf;
+    }
+    return count + 1;
+}
+
+/**
+ * Length of the run of ASCII bytes starting at p, counted 16 bytes at a time.
+ */
+static size_t asciiPrefixLength(const unsigned char *p, size_t size)
+{
+    size_t i = 0;
+#ifdef UTF8_SSE2
+    while (i + 16 <= size && _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i))) == 0)
+    {
+        i += 16;
+    }
+#endif
+    while (i < size && p[i] < 0x80)
+    {
+        i++;
+    }
+    return i;
+}
+
+bool isValidUtf8(std::string_view text)
+{
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(text.data());
+    const size_t size = text.size();
+    size_t i = 0;
+    while ((i += asciiPrefixLength(p + i, size - i)) < size)
+    {
+        uint32_t codePoint;
+        const int length = decodeUtf8(p + i, size - i, codePoint);
+        if (length < 0)
+        {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+void appendUtf8(std::string &text, uint32_t codePoint)
+{
+    if (codePoint < 0x80)
+    {
+        text += static_cast<char>(codePoint);
+    }
+    else if (codePoint < 0x800)
+    {
+        text += static_cast<char>(0xc0 | (codePoint >> 6));
+        text += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+    else if (codePoint < 0x10000)
+    {
+        text += static_cast<char>(0xe0 | (codePoint >> 12));
+        text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        text += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+    else
+    {
+        text += static_cast<char>(0xf0 | (codePoint >> 18));
+        text += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+        text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        text += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+}
+
+std::string repairUtf8(std::string_view text)
+{
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(text.data());
+    const size_t size = text.size();
+    std::string repaired;
+    repaired.reserve(size + 2);
+    size_t i = 0;
+    while (i < size)
+    {
+        uint32_t codePoint;
+        const int length = decodeUtf8(p + i, size - i, codePoint);
+        if (length > 0)
+        {
+            repaired.append(text.data() + i, length);
+            i += length;
+        }
+        else
+        {
+            repaired += "\xef\xbf\xbd";
+            i += -length;
+        }
+    }
+    return repaired;
+}
+
+bool isNfcQuick(std::string_view text)
+{
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(text.data());
+    const size_t size = text.size();
+    size_t i = 0;
+    while ((i += asciiPrefixLength(p + i, size - i)) < size)
+    {
+        uint32_t codePoint;
+        const int length = decodeUtf8(p + i, size - i, codePoint);
+        if (length < 0)
+        {
+            return false;
+        }
+        // Code points below U+0300, CJK unified ideographs and fullwidth forms neither
+        // decompose nor combine with their neighbours.
+        const bool isStable = codePoint < 0x300 ||
+                              (codePoint >= 0x4e00 && codePoint <= 0x9fff) ||
+                              (codePoint >= 0xff01 && codePoint <= 0xffef);
+        if (!isStable)
+        {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+std::string normalizeNfc(std::string_view text)
+{
+    const QString string = QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()));
+    return string.normalized(QString::NormalizationForm_C).toStdString();
+}
@@ -0,0 +1,36 @@
+#ifndef UTF8_HPP
+#define UTF8_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * Check whether the text is well-formed UTF-8, i.e. without overlong forms, surrogates or
+ * code points above U+10FFFF.
+ */
+bool isValidUtf8(std::string_view text);
+
+/**
+ * Append the UTF-8 encoding of a code point.
+ */
+void appendUtf8(std::string &text, uint32_t codePoint);
+
+/**
+ * Replace every ill-formed sequence of the text with U+FFFD.
+ */
+std::string repairUtf8(std::string_view text);
+
+/**
+ * Cheap check whether valid UTF-8 text is already in NFC.
+ *
+ * @return true when the text is known to be in NFC, false when it has to be normalized to tell.
+ */
+bool isNfcQuick(std::string_view text);
+
+/**
+ * Normalize valid UTF-8 text to NFC.
+ */
+std::string normalizeNfc(std::string_view text);
+
+#endif // UTF8_HPP
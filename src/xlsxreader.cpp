@@ -0,0 +1,376 @@
+#include "xlsxreader.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include "utf8.hpp"
+
+static const std::string workbookName = "xl/workbook.xml";
+static const std::string workbookRelationshipsName = "xl/_rels/workbook.xml.rels";
+
+/**
+ * Reader of XML held whole.
+ */
+static XmlReader readXmlString(std::string_view xml)
+{
+    return XmlReader([xml]() mutable
+    {
+        return std::exchange(xml, std::string_view());
+    });
+}
+
+static std::string decodeXmlText(std::string_view encoded)
+{
+    std::string text;
+    appendXmlText(encoded, text);
+    return text;
+}
+
+/**
+ * Append XML text with the _xHHHH_ escapes of Office decoded too, e.g. _x000D_ for a CR.
+ */
+static void appendOfficeText(std::string_view encoded, std::string &text)
+{
+    if (encoded.find('_') == std::string_view::npos)
+    {
+        appendXmlText(encoded, text);
+        return;
+    }
+
+    const std::string decoded = decodeXmlText(encoded);
+    size_t pos = 0;
+    for (size_t escape = decoded.find("_x"); escape != std::string::npos; escape = decoded.find("_x", escape + 1))
+    {
+        if (escape + 7 > decoded.size() || decoded[escape + 6] != '_' ||
+            !std::all_of(decoded.begin() + static_cast<std::ptrdiff_t>(escape + 2), decoded.begin() + static_cast<std::ptrdiff_t>(escape + 6), [](unsigned char c)
+            {
+                return std::isxdigit(c) != 0;
+            }))
+        {
+            continue;
+        }
+        text.append(decoded, pos, escape - pos);
+        const uint32_t codePoint = static_cast<uint32_t>(std::stoul(decoded.substr(escape + 2, 4), nullptr, 16));
+        appendUtf8(text, codePoint >= 0xd800 && codePoint <= 0xdfff ? 0xfffd : codePoint);
+        pos = escape + 7;
+        escape += 6;
+    }
+    text.append(decoded, pos, std::string::npos);
+}
+
+/**
+ * Target of the first workbook relationship accepted by isWanted, as an entry name.
+ */
+template <typename Predicate>
+static std::string findRelationshipTarget(const ZipArchive &zip, Predicate isWanted)
+{
+    if (!zip.contains(workbookRelationshipsName))
+    {
+        return "";
+    }
+    const std::string xml = zip.read(workbookRelationshipsName);
+    XmlReader reader = readXmlString(xml);
+    for (XmlReader::Token token = reader.next(); token != XmlReader::Token::End; token = reader.next())
+    {
+        if (token != XmlReader::Token::StartElement || reader.name() != "Relationship" || !isWanted(reader))
+        {
+            continue;
+        }
+        const std::string target = decodeXmlText(reader.attribute("Target").value_or(""));
+        // Targets are relative to the xl folder, or absolute within the package.
+        return target.empty() || target[0] != '/' ? "xl/" + target : target.substr(1);
+    }
+    return "";
+}
+
+static std::string findFirstSheetName(const ZipArchive &zip)
+{
+    if (!zip.contains(workbookName))
+    {
+        throw std::runtime_error("not an .xlsx workbook");
+    }
+
+    const std::string xml = zip.read(workbookName);
+    XmlReader reader = readXmlString(xml);
+    std::string id;
+    for (XmlReader::Token token = reader.next(); token != XmlReader::Token::End; token = reader.next())
+    {
+        if (token == XmlReader::Token::StartElement && reader.name() == "sheet")
+        {
+            id = decodeXmlText(reader.attribute("r:id").value_or(""));
+            break;
+        }
+    }
+    std::string sheetName = findRelationshipTarget(zip, [&](const XmlReader &relationship)
+    {
+        return relationship.attribute("Id") == std::optional<std::string_view>(id);
+    });
+    if (sheetName.empty())
+    {
+        sheetName = "xl/worksheets/sheet1.xml";
+    }
+    if (!zip.contains(sheetName))
+    {
+        throw std::runtime_error("worksheet not found in the workbook: " + sheetName);
+    }
+    return sheetName;
+}
+
+static std::string findSharedStringsName(const ZipArchive &zip)
+{
+    const std::string name = findRelationshipTarget(zip, [](const XmlReader &relationship)
+    {
+        const std::string_view type = relationship.attribute("Type").value_or("");
+        const std::string_view suffix = "/sharedStrings";
+        return type.size() >= suffix.size() && type.substr(type.size() - suffix.size()) == suffix;
+    });
+    return name.empty() ? "xl/sharedStrings.xml" : name;
+}
+
+/**
+ * Row number or string index of the worksheet.
+ */
+static size_t parseNumber(std::string_view text)
+{
+    size_t number = 0;
+    for (char c : text)
+    {
+        if (c < '0' || c > '9' || number > 0xffffffff)
+        {
+            throw std::runtime_error("invalid .xlsx worksheet number: " + std::string(text));
+        }
+        number = number * 10 + static_cast<size_t>(c - '0');
+    }
+    if (text.empty())
+    {
+        throw std::runtime_error("invalid .xlsx worksheet: empty number");
+    }
+    return number;
+}
+
+/**
+ * Zero-based column of a cell reference such as "AB12".
+ */
+static size_t parseColumn(std::string_view reference)
+{
+    size_t column = 0;
+    for (char c : reference)
+    {
+        if (c < 'A' || c > 'Z')
+        {
+            break;
+        }
+        column = column * 26 + static_cast<size_t>(c - 'A' + 1);
+    }
+    if (column == 0 || column > 16384)
+    {
+        throw std::runtime_error("invalid .xlsx cell reference: " + std::string(reference));
+    }
+    return column - 1;
+}
+
+XlsxReader::XlsxReader(std::string_view data)
+    : zip(data),
+      sheetName(findFirstSheetName(zip)),
+      sharedStringsName(findSharedStringsName(zip)),
+      sheetInflater(zip.open(sheetName)),
+      sheetXml([this]()
+               {
+                   return sheetInflater.next();
+               })
+{
+}
+
+void XlsxReader::appendSharedString(size_t index, std::string &text)
+{
+    if (!areSharedStringsRead)
+    {
+        areSharedStringsRead = true;
+        if (zip.contains(sharedStringsName))
+        {
+            sharedStringsXml = zip.read(sharedStringsName);
+        }
+        // Text cannot hold a '<', so "<si" starts an element unless a longer name follows.
+        for (size_t pos = sharedStringsXml.find("<si"); pos != std::string::npos; pos = sharedStringsXml.find("<si", pos + 3))
+        {
+            const char next = pos + 3 < sharedStringsXml.size() ? sharedStringsXml[pos + 3] : 0;
+            if (next == '>' || next == '/' || next == ' ')
+            {
+                sharedStringOffsets.push_back(pos);
+            }
+        }
+        sharedStringOffsets.push_back(sharedStringsXml.size());
+    }
+
+    if (index + 1 >= sharedStringOffsets.size())
+    {
+        throw std::runtime_error("invalid .xlsx shared string index: " + std::to_string(index));
+    }
+    const size_t start = sharedStringOffsets[index];
+    const std::string_view element = std::string_view(sharedStringsXml).substr(start, sharedStringOffsets[index + 1] - start);
+
+    // Most strings are a single <t> element, read without a parser.
+    if (element.substr(0, 6) == "<si><t")
+    {
+        const size_t textStart = element.find('>', 6) + 1;
+        const size_t textEnd = element.find('<', textStart);
+        if (textStart != 0 && element[textStart - 2] != '/' && textEnd != std::string_view::npos && element.substr(textEnd, 9) == "</t></si>")
+        {
+            appendOfficeText(element.substr(textStart, textEnd - textStart), text);
+            return;
+        }
+    }
+
+    XmlReader reader = readXmlString(element);
+
+    // The text runs of a rich text string, without their phonetic reading (rPh).
+    int phoneticDepth = 0;
+    bool isInText = false;
+    for (XmlReader::Token token = reader.next(); token != XmlReader::Token::End; token = reader.next())
+    {
+        if (token == XmlReader::Token::StartElement)
+        {
+            phoneticDepth += reader.name() == "rPh";
+            isInText = reader.name() == "t" && phoneticDepth == 0;
+        }
+        else if (token == XmlReader::Token::EndElement)
+        {
+            if (reader.name() == "si")
+            {
+                break;
+            }
+            phoneticDepth -= reader.name() == "rPh";
+            isInText = false;
+        }
+        else if (token == XmlReader::Token::Text && isInText)
+        {
+            appendOfficeText(reader.text(), text);
+        }
+    }
+}
+
+bool XlsxReader::findRow()
+{
+    for (XmlReader::Token token = sheetXml.next(); token != XmlReader::Token::End; token = sheetXml.next())
+    {
+        if (token == XmlReader::Token::StartElement && sheetXml.name() == "row")
+        {
+            const std::optional<std::string_view> reference = sheetXml.attribute("r");
+            rowNumber = reference ? parseNumber(*reference) : nextRowNumber;
+            if (rowNumber < nextRowNumber)
+            {
+                throw std::runtime_error("invalid .xlsx worksheet: rows out of order");
+            }
+            return true;
+        }
+        if (token == XmlReader::Token::EndElement && sheetXml.name() == "sheetData")
+        {
+            break;
+        }
+    }
+    return false;
+}
+
+void XlsxReader::readCells(std::vector<std::string> &cells)
+{
+    cells.clear();
+    std::string value;
+    std::string type;
+    size_t column = 0;
+    // Inside <v> or the <t> of an inline string, and inside its phonetic reading.
+    bool isInValue = false;
+    int phoneticDepth = 0;
+    for (XmlReader::Token token = sheetXml.next(); token != XmlReader::Token::End; token = sheetXml.next())
+    {
+        if (token == XmlReader::Token::StartElement)
+        {
+            const std::string_view name = sheetXml.name();
+            if (name == "c")
+            {
+                const std::optional<std::string_view> reference = sheetXml.attribute("r");
+                column = reference ? parseColumn(*reference) : cells.size();
+                type = sheetXml.attribute("t").value_or("n");
+                value.clear();
+            }
+            else
+            {
+                phoneticDepth += name == "rPh";
+                isInValue = (name == "v" || name == "t") && phoneticDepth == 0;
+            }
+        }
+        else if (token == XmlReader::Token::Text && isInValue)
+        {
+            // Raw until the cell ends, since a shared string is only an index.
+            value.append(sheetXml.text());
+        }
+        else if (token == XmlReader::Token::EndElement)
+        {
+            const std::string_view name = sheetXml.name();
+            if (name == "row")
+            {
+                return;
+            }
+            phoneticDepth -= name == "rPh";
+            isInValue = false;
+            if (name != "c")
+            {
+                continue;
+            }
+
+            if (column >= cells.size())
+            {
+                cells.resize(column + 1);
+            }
+            std::string &cell = cells[column];
+            cell.clear();
+            if (type == "s")
+            {
+                if (!value.empty())
+                {
+                    appendSharedString(parseNumber(value), cell);
+                }
+            }
+            else if (type == "b")
+            {
+                cell = value == "1" ? "TRUE" : "FALSE";
+            }
+            else if (type == "inlineStr" || type == "str")
+            {
+                appendOfficeText(value, cell);
+            }
+            else
+            {
+                appendXmlText(value, cell);
+            }
+        }
+    }
+    throw std::runtime_error("invalid .xlsx worksheet: unexpected end of a row");
+}
+
+bool XlsxReader::readRow(std::vector<std::string> &cells)
+{
+    // Blank rows are only read as the gap before the next row with text, so that the blank
+    // rows Excel keeps after the data for their formatting are left out.
+    while (!isRowRead)
+    {
+        if (!findRow())
+        {
+            return false;
+        }
+        readCells(rowCells);
+        isRowRead = std::any_of(rowCells.begin(), rowCells.end(), [](const std::string &cell)
+        {
+            return !cell.empty();
+        });
+    }
+
+    cells.clear();
+    if (nextRowNumber == rowNumber)
+    {
+        cells.swap(rowCells);
+        isRowRead = false;
+    }
+    nextRowNumber++;
+    return true;
+}
@@ -0,0 +1,68 @@
+#ifndef XLSX_READER_HPP
+#define XLSX_READER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "sheetreader.hpp"
+#include "xmlreader.hpp"
+#include "zipreader.hpp"
+
+/**
+ * Reader of the rows of the first worksheet of an Excel .xlsx workbook.
+ *
+ * The worksheet XML is parsed while it is inflated, so only the current row is held. The
+ * shared strings table is inflated whole but a string is decoded only when a cell refers to
+ * it. Cells are read as text: formulas as their cached value, booleans as TRUE or FALSE,
+ * numbers and dates as stored, e.g. a date as its serial number.
+ */
+class XlsxReader : public SheetReader
+{
+public:
+    /**
+     * Open a workbook held in memory, which must outlive the reader.
+     *
+     * Throws std::runtime_error when the data is not an .xlsx workbook.
+     */
+    explicit XlsxReader(std::string_view data);
+
+    XlsxReader(const XlsxReader &) = delete;
+    XlsxReader &operator=(const XlsxReader &) = delete;
+
+    /**
+     * Replace the cells with those of the next row, up to its last cell with text. Like in a
+     * CSV export, the rows missing from the worksheet are read as empty ones.
+     *
+     * @return false after the last row.
+     */
+    bool readRow(std::vector<std::string> &cells) override;
+
+private:
+    /**
+     * Go to the next <row> element and take its number.
+     */
+    bool findRow();
+    void readCells(std::vector<std::string> &cells);
+    void appendSharedString(size_t index, std::string &text);
+
+    ZipArchive zip;
+    // Worksheet and shared strings entries.
+    std::string sheetName;
+    std::string sharedStringsName;
+    Inflater sheetInflater;
+    XmlReader sheetXml;
+
+    // Inflated on the first reference to a shared string, with the offsets of its <si> elements.
+    bool areSharedStringsRead = false;
+    std::string sharedStringsXml;
+    std::vector<size_t> sharedStringOffsets;
+
+    // One-based number of the row found and of the next row to read.
+    size_t rowNumber = 0;
+    size_t nextRowNumber = 1;
+    // Cells of the row found, read after the blank rows before it.
+    std::vector<std::string> rowCells;
+    bool isRowRead = false;
+};
+
+#endif // XLSX_READER_HPP
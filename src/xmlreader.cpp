@@ -0,0 +1,314 @@
+#include "xmlreader.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include "utf8.hpp"
+
+static bool isXmlSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+XmlReader::XmlReader(std::function<std::string_view()> readPiece) : readPiece(std::move(readPiece))
+{
+}
+
+bool XmlReader::readMore()
+{
+    const std::string_view piece = readPiece();
+    if (piece.empty())
+    {
+        return false;
+    }
+    buffer.erase(0, pos);
+    pos = 0;
+    buffer.append(piece);
+    return true;
+}
+
+XmlReader::Token XmlReader::next()
+{
+    if (isEndPending)
+    {
+        isEndPending = false;
+        token = Token::EndElement;
+        return token;
+    }
+
+    // Offsets are taken from pos since reading more moves the buffered data.
+    const auto findAhead = [this](std::string_view pattern, size_t offset)
+    {
+        size_t found = buffer.find(pattern, pos + offset);
+        while (found == std::string::npos)
+        {
+            const size_t searchedSize = buffer.size() - pos;
+            if (!readMore())
+            {
+                return std::string::npos;
+            }
+            found = buffer.find(pattern, pos + std::max(offset, searchedSize >= pattern.size() ? searchedSize - pattern.size() + 1 : 0));
+        }
+        return found - pos;
+    };
+    const auto skipAhead = [&](std::string_view pattern, size_t offset)
+    {
+        const size_t found = findAhead(pattern, offset);
+        if (found == std::string::npos)
+        {
+            throw std::runtime_error("invalid XML: unexpected end");
+        }
+        pos += found + pattern.size();
+    };
+
+    while (true)
+    {
+        if (pos == buffer.size() && !readMore())
+        {
+            token = Token::End;
+            return token;
+        }
+
+        if (buffer[pos] != '<')
+        {
+            size_t size = findAhead("<", 0);
+            if (size == std::string::npos)
+            {
+                size = buffer.size() - pos;
+            }
+            content = std::string_view(buffer).substr(pos, size);
+            pos += size;
+            token = Token::Text;
+            return token;
+        }
+
+        // Enough to tell markup from elements.
+        while (buffer.size() - pos < 9 && readMore())
+        {
+        }
+        const std::string_view start = std::string_view(buffer).substr(pos, 9);
+        if (start.substr(0, 4) == "<!--")
+        {
+            skipAhead("-->", 4);
+            continue;
+        }
+        if (start.substr(0, 2) == "<?")
+        {
+            skipAhead("?>", 2);
+            continue;
+        }
+        if (start == "<![CDATA[")
+        {
+            throw std::runtime_error("XML CDATA sections are not supported");
+        }
+        if (start.substr(0, 2) == "<!")
+        {
+            skipAhead(">", 2);
+            continue;
+        }
+
+        // The tag ends at the first '>' outside of attribute values.
+        size_t size = 1;
+        char quote = 0;
+        while (true)
+        {
+            if (pos + size == buffer.size() && !readMore())
+            {
+                throw std::runtime_error("invalid XML: unexpected end");
+            }
+            const char c = buffer[pos + size];
+            if (quote != 0)
+            {
+                quote = c == quote ? 0 : quote;
+            }
+            else if (c == '"' || c == '\'')
+            {
+                quote = c;
+            }
+            else if (c == '>')
+            {
+                break;
+            }
+            size++;
+        }
+        content = std::string_view(buffer).substr(pos + 1, size - 1);
+        pos += size + 1;
+
+        if (!content.empty() && content[0] == '/')
+        {
+            elementName = content.substr(1);
+            while (!elementName.empty() && isXmlSpace(elementName.back()))
+            {
+                elementName.remove_suffix(1);
+            }
+            token = Token::EndElement;
+            return token;
+        }
+        if (!content.empty() && content.back() == '/')
+        {
+            content.remove_suffix(1);
+            isEndPending = true;
+        }
+        size_t nameSize = 0;
+        while (nameSize < content.size() && !isXmlSpace(content[nameSize]))
+        {
+            nameSize++;
+        }
+        if (nameSize == 0)
+        {
+            throw std::runtime_error("invalid XML: element without a name");
+        }
+        elementName = content.substr(0, nameSize);
+        token = Token::StartElement;
+        return token;
+    }
+}
+
+std::string_view XmlReader::name() const
+{
+    return elementName;
+}
+
+std::optional<std::string_view> XmlReader::attribute(std::string_view name) const
+{
+    size_t i = elementName.size();
+    while (true)
+    {
+        while (i < content.size() && isXmlSpace(content[i]))
+        {
+            i++;
+        }
+        if (i == content.size())
+        {
+            return std::nullopt;
+        }
+        const size_t nameStart = i;
+        while (i < content.size() && content[i] != '=' && !isXmlSpace(content[i]))
+        {
+            i++;
+        }
+        const std::string_view attributeName = content.substr(nameStart, i - nameStart);
+        while (i < content.size() && isXmlSpace(content[i]))
+        {
+            i++;
+        }
+        if (i + 1 >= content.size() || content[i] != '=')
+        {
+            throw std::runtime_error("invalid XML: attribute without a value in <" + std::string(elementName) + ">");
+        }
+        i++;
+        while (i < content.size() && isXmlSpace(content[i]))
+        {
+            i++;
+        }
+        const char quote = i < content.size() ? content[i] : 0;
+        const size_t valueEnd = quote == '"' || quote == '\'' ? content.find(quote, i + 1) : std::string_view::npos;
+        if (valueEnd == std::string_view::npos)
+        {
+            throw std::runtime_error("invalid XML: unquoted attribute value in <" + std::string(elementName) + ">");
+        }
+        if (attributeName == name)
+        {
+            return content.substr(i + 1, valueEnd - i - 1);
+        }
+        i = valueEnd + 1;
+    }
+}
+
+std::string_view XmlReader::text() const
+{
+    return content;
+}
+
+/**
+ * Decode a character reference without its '&' and ';', e.g. "#x41".
+ */
+static bool appendCharacterReference(std::string_view reference, std::string &text)
+{
+    const bool isHex = reference.size() > 1 && (reference[1] == 'x' || reference[1] == 'X');
+    const size_t digitsStart = isHex ? 2 : 1;
+    if (reference.size() == digitsStart || reference.size() > digitsStart + 8)
+    {
+        return false;
+    }
+    uint32_t codePoint = 0;
+    for (size_t i = digitsStart; i < reference.size(); i++)
+    {
+        const char c = reference[i];
+        uint32_t digit = 0;
+        if (c >= '0' && c <= '9')
+        {
+            digit = static_cast<uint32_t>(c - '0');
+        }
+        else if (isHex && c >= 'a' && c <= 'f')
+        {
+            digit = static_cast<uint32_t>(c - 'a' + 10);
+        }
+        else if (isHex && c >= 'A' && c <= 'F')
+        {
+            digit = static_cast<uint32_t>(c - 'A' + 10);
+        }
+        else
+        {
+            return false;
+        }
+        codePoint = codePoint * (isHex ? 16 : 10) + digit;
+    }
+    if (codePoint > 0x10ffff)
+    {
+        return false;
+    }
+    appendUtf8(text, codePoint >= 0xd800 && codePoint <= 0xdfff ? 0xfffd : codePoint);
+    return true;
+}
+
+void appendXmlText(std::string_view encoded, std::string &text)
+{
+    size_t pos = 0;
+    while (true)
+    {
+        const size_t ampersand = encoded.find('&', pos);
+        text.append(encoded.substr(pos, ampersand - pos));
+        if (ampersand == std::string_view::npos)
+        {
+            return;
+        }
+        const size_t semicolon = encoded.find(';', ampersand);
+        const std::string_view reference = semicolon == std::string_view::npos ? std::string_view() : encoded.substr(ampersand + 1, semicolon - ampersand - 1);
+        bool isDecoded = true;
+        if (reference == "amp")
+        {
+            text += '&';
+        }
+        else if (reference == "lt")
+        {
+            text += '<';
+        }
+        else if (reference == "gt")
+        {
+            text += '>';
+        }
+        else if (reference == "quot")
+        {
+            text += '"';
+        }
+        else if (reference == "apos")
+        {
+            text += '\'';
+        }
+        else
+        {
+            isDecoded = !reference.empty() && reference[0] == '#' && appendCharacterReference(reference, text);
+        }
+        // Anything else is kept as it is.
+        if (!isDecoded)
+        {
+            text += '&';
+            pos = ampersand + 1;
+        }
+        else
+        {
+            pos = semicolon + 1;
+        }
+    }
+}
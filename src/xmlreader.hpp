@@ -0,0 +1,72 @@
+#ifndef XML_READER_HPP
+#define XML_READER_HPP
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * Pull parser of XML read piece by piece, e.g. from an Inflater, for the documents of
+ * spreadsheet files. Only the pieces not parsed yet are buffered.
+ *
+ * Comments, processing instructions and the DOCTYPE are skipped, CDATA sections are not
+ * supported. Names keep their namespace prefix, e.g. "table:table-cell".
+ */
+class XmlReader
+{
+public:
+    enum class Token
+    {
+        StartElement,
+        EndElement,
+        Text,
+        End,
+    };
+
+    /**
+     * Parse the pieces returned by readPiece until it returns an empty one.
+     */
+    explicit XmlReader(std::function<std::string_view()> readPiece);
+
+    /**
+     * Read the next token, an empty element such as <a/> is a start then an end.
+     *
+     * Throws std::runtime_error on malformed XML.
+     */
+    Token next();
+
+    /**
+     * Name of the element started or ended.
+     */
+    std::string_view name() const;
+
+    /**
+     * Value of an attribute of the element started, entities still encoded.
+     */
+    std::optional<std::string_view> attribute(std::string_view name) const;
+
+    /**
+     * Text read, entities still encoded.
+     */
+    std::string_view text() const;
+
+private:
+    bool readMore();
+
+    std::function<std::string_view()> readPiece;
+    std::string buffer;
+    size_t pos = 0;
+    Token token = Token::End;
+    bool isEndPending = false;
+    // Content of the tag read between its angle brackets, or the text read.
+    std::string_view content;
+    std::string_view elementName;
+};
+
+/**
+ * Append XML text or an attribute value with its entities decoded.
+ */
+void appendXmlText(std::string_view encoded, std::string &text);
+
+#endif // XML_READER_HPP
@@ -0,0 +1,454 @@
+#include "zipreader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+// Matches refer up to 32 KB back and copy up to 258 bytes.
+static const size_t historySize = 32 * 1024;
+static const size_t maxMatchSize = 258;
+static const size_t windowSize = 5 * historySize;
+
+static const uint16_t lengthBases[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                       35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t lengthExtraBits[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                          3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t distanceBases[] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                                         193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+                                         6145, 8193, 12289, 16385, 24577};
+static const uint8_t distanceExtraBits[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+// Order in which a dynamic block lists the lengths of the code length code.
+static const uint8_t codeLengthOrder[] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+Inflater::Inflater(std::string_view compressed, bool isStored) : compressed(compressed), isStored(isStored)
+{
+    if (!isStored)
+    {
+        window.resize(windowSize);
+    }
+}
+
+void Inflater::buildTable(const uint8_t *lengths, size_t count, HuffmanTable &table)
+{
+    table.fastEntries.fill(0);
+    table.lengthCounts.fill(0);
+    for (size_t i = 0; i < count; i++)
+    {
+        table.lengthCounts[lengths[i]]++;
+    }
+    table.lengthCounts[0] = 0;
+
+    // An incomplete code is allowed, e.g. a lone distance code, its unused codes fail to decode.
+    int left = 1;
+    uint32_t code = 0;
+    uint16_t offset = 0;
+    std::array<uint32_t, 16> nextCodes = {};
+    std::array<uint16_t, 16> offsets = {};
+    for (int length = 1; length < 16; length++)
+    {
+        left = (left << 1) - table.lengthCounts[length];
+        if (left < 0)
+        {
+            throw std::runtime_error("invalid deflate data: over-subscribed code");
+        }
+        code = (code + table.lengthCounts[length - 1]) << 1;
+        nextCodes[length] = code;
+        offset = static_cast<uint16_t>(offset + table.lengthCounts[length - 1]);
+        offsets[length] = offset;
+    }
+
+    for (size_t symbol = 0; symbol < count; symbol++)
+    {
+        const int length = lengths[symbol];
+        if (length == 0)
+        {
+            continue;
+        }
+        table.symbols[offsets[length]++] = static_cast<uint16_t>(symbol);
+        if (length <= HuffmanTable::fastBits)
+        {
+            // Codes are packed from their most significant bit, the bits are read from the least.
+            uint32_t reversed = 0;
+            for (int i = 0; i < length; i++)
+            {
+                reversed |= ((nextCodes[length] >> i) & 1) << (length - 1 - i);
+            }
+            for (uint32_t i = reversed; i < table.fastEntries.size(); i += 1u << length)
+            {
+                table.fastEntries[i] = static_cast<uint16_t>(symbol << 4 | length);
+            }
+        }
+        nextCodes[length]++;
+    }
+}
+
+void Inflater::refill()
+{
+    while (bitCount <= 56)
+    {
+        // Past the end zeros are read, consumedBitCount tells whether they were used.
+        const uint64_t byte = inputPos < compressed.size() ? static_cast<uint8_t>(compressed[inputPos]) : 0;
+        inputPos++;
+        bitBuffer |= byte << bitCount;
+        bitCount += 8;
+    }
+}
+
+uint32_t Inflater::peekBits(int count)
+{
+    if (bitCount < count)
+    {
+        refill();
+    }
+    return static_cast<uint32_t>(bitBuffer & ((uint64_t(1) << count) - 1));
+}
+
+void Inflater::skipBits(int count)
+{
+    bitBuffer >>= count;
+    bitCount -= count;
+    consumedBitCount += count;
+    if (consumedBitCount > compressed.size() * 8)
+    {
+        throw std::runtime_error("invalid deflate data: unexpected end");
+    }
+}
+
+uint32_t Inflater::readBits(int count)
+{
+    const uint32_t bits = peekBits(count);
+    skipBits(count);
+    return bits;
+}
+
+int Inflater::decodeSymbol(const HuffmanTable &table)
+{
+    const uint32_t bits = peekBits(15);
+    const uint16_t entry = table.fastEntries[bits & ((1u << HuffmanTable::fastBits) - 1)];
+    if (entry != 0)
+    {
+        skipBits(entry & 15);
+        return entry >> 4;
+    }
+
+    // Longer codes are rare, they are decoded bit by bit.
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (int length = 1; length < 16; length++)
+    {
+        code |= (bits >> (length - 1)) & 1;
+        const int count = table.lengthCounts[length];
+        if (code - first < count)
+        {
+            skipBits(length);
+            return table.symbols[index + code - first];
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    throw std::runtime_error("invalid deflate data: unknown code");
+}
+
+void Inflater::readBlockHeader()
+{
+    isFinalBlock = readBits(1) == 1;
+    blockType = static_cast<int>(readBits(2));
+    if (blockType == 0)
+    {
+        skipBits(bitCount % 8);
+        const uint32_t size = readBits(16);
+        const uint32_t complement = readBits(16);
+        if ((size ^ 0xffff) != complement)
+        {
+            throw std::runtime_error("invalid deflate data: stored block size mismatch");
+        }
+        storedSize = size;
+    }
+    else if (blockType == 1)
+    {
+        uint8_t lengths[288 + 30];
+        std::fill(lengths, lengths + 144, uint8_t(8));
+        std::fill(lengths + 144, lengths + 256, uint8_t(9));
+        std::fill(lengths + 256, lengths + 280, uint8_t(7));
+        std::fill(lengths + 280, lengths + 288, uint8_t(8));
+        std::fill(lengths + 288, lengths + 318, uint8_t(5));
+        buildTable(lengths, 288, literalTable);
+        buildTable(lengths + 288, 30, distanceTable);
+    }
+    else if (blockType == 2)
+    {
+        readDynamicTables();
+    }
+    else
+    {
+        throw std::runtime_error("invalid deflate data: unknown block type");
+    }
+}
+
+void Inflater::readDynamicTables()
+{
+    const size_t literalCount = readBits(5) + 257;
+    const size_t distanceCount = readBits(5) + 1;
+    const size_t codeLengthCount = readBits(4) + 4;
+    if (literalCount > 286 || distanceCount > 30)
+    {
+        throw std::runtime_error("invalid deflate data: too many codes");
+    }
+
+    uint8_t codeLengthLengths[19] = {};
+    for (size_t i = 0; i < codeLengthCount; i++)
+    {
+        codeLengthLengths[codeLengthOrder[i]] = static_cast<uint8_t>(readBits(3));
+    }
+    HuffmanTable codeLengthTable;
+    buildTable(codeLengthLengths, 19, codeLengthTable);
+
+    // Literal and distance code lengths are one sequence, repeats may cross from one to the other.
+    uint8_t lengths[286 + 30] = {};
+    size_t count = 0;
+    while (count < literalCount + distanceCount)
+    {
+        const int symbol = decodeSymbol(codeLengthTable);
+        if (symbol < 16)
+        {
+            lengths[count++] = static_cast<uint8_t>(symbol);
+            continue;
+        }
+        uint8_t length = 0;
+        size_t repeatCount = 0;
+        if (symbol == 16)
+        {
+            if (count == 0)
+            {
+                throw std::runtime_error("invalid deflate data: repeat without a length");
+            }
+            length = lengths[count - 1];
+            repeatCount = 3 + readBits(2);
+        }
+        else if (symbol == 17)
+        {
+            repeatCount = 3 + readBits(3);
+        }
+        else
+        {
+            repeatCount = 11 + readBits(7);
+        }
+        if (count + repeatCount > literalCount + distanceCount)
+        {
+            throw std::runtime_error("invalid deflate data: too many code lengths");
+        }
+        std::fill(lengths + count, lengths + count + repeatCount, length);
+        count += repeatCount;
+    }
+    if (lengths[256] == 0)
+    {
+        throw std::runtime_error("invalid deflate data: no end of block code");
+    }
+    buildTable(lengths, literalCount, literalTable);
+    buildTable(lengths + literalCount, distanceCount, distanceTable);
+}
+
+void Inflater::inflateBlocks()
+{
+    while (!isDone && windowPos + maxMatchSize <= window.size())
+    {
+        if (blockType < 0)
+        {
+            readBlockHeader();
+        }
+
+        if (blockType == 0)
+        {
+            // Whole bytes are left in the bit buffer after the block header.
+            while (storedSize > 0 && windowPos < window.size())
+            {
+                window[windowPos++] = static_cast<char>(readBits(8));
+                storedSize--;
+            }
+            if (storedSize == 0)
+            {
+                blockType = -1;
+                isDone = isFinalBlock;
+            }
+        }
+        else
+        {
+            while (windowPos + maxMatchSize <= window.size())
+            {
+                const int symbol = decodeSymbol(literalTable);
+                if (symbol < 256)
+                {
+                    window[windowPos++] = static_cast<char>(symbol);
+                    continue;
+                }
+                if (symbol == 256)
+                {
+                    blockType = -1;
+                    isDone = isFinalBlock;
+                    break;
+                }
+                if (symbol > 285)
+                {
+                    throw std::runtime_error("invalid deflate data: unknown length code");
+                }
+                const size_t size = lengthBases[symbol - 257] + readBits(lengthExtraBits[symbol - 257]);
+                const int distanceSymbol = decodeSymbol(distanceTable);
+                if (distanceSymbol >= 30)
+                {
+                    throw std::runtime_error("invalid deflate data: unknown distance code");
+                }
+                const size_t distance = distanceBases[distanceSymbol] + readBits(distanceExtraBits[distanceSymbol]);
+                if (distance > windowPos)
+                {
+                    throw std::runtime_error("invalid deflate data: distance too far back");
+                }
+                // Byte by byte since the source may overlap the copy.
+                char *target = window.data() + windowPos;
+                const char *source = target - distance;
+                for (size_t i = 0; i < size; i++)
+                {
+                    target[i] = source[i];
+                }
+                windowPos += size;
+            }
+        }
+    }
+}
+
+std::string_view Inflater::next()
+{
+    if (isStored)
+    {
+        return std::exchange(compressed, std::string_view());
+    }
+    if (windowPos > historySize)
+    {
+        std::memmove(window.data(), window.data() + windowPos - historySize, historySize);
+        windowPos = historySize;
+    }
+    const size_t pieceStart = windowPos;
+    inflateBlocks();
+    return std::string_view(window.data() + pieceStart, windowPos - pieceStart);
+}
+
+static uint16_t readUint16(std::string_view data, size_t pos)
+{
+    return static_cast<uint16_t>(static_cast<uint8_t>(data[pos]) | static_cast<uint8_t>(data[pos + 1]) << 8);
+}
+
+static uint32_t readUint32(std::string_view data, size_t pos)
+{
+    return static_cast<uint32_t>(readUint16(data, pos)) | static_cast<uint32_t>(readUint16(data, pos + 2)) << 16;
+}
+
+ZipArchive::ZipArchive(std::string_view data) : data(data)
+{
+    // The end of central directory record is last, followed by a comment of up to 64 KB.
+    const size_t endRecordSize = 22;
+    if (data.size() < endRecordSize)
+    {
+        throw std::runtime_error("not a ZIP archive");
+    }
+    size_t endPos = data.size() - endRecordSize;
+    const size_t searchEnd = endPos > 0xffff ? endPos - 0xffff : 0;
+    while (readUint32(data, endPos) != 0x06054b50)
+    {
+        if (endPos == searchEnd)
+        {
+            throw std::runtime_error("not a ZIP archive");
+        }
+        endPos--;
+    }
+
+    const uint16_t entryCount = readUint16(data, endPos + 10);
+    const uint32_t directoryOffset = readUint32(data, endPos + 16);
+    if (entryCount == 0xffff || directoryOffset == 0xffffffff)
+    {
+        throw std::runtime_error("ZIP64 archives are not supported");
+    }
+
+    size_t pos = directoryOffset;
+    for (uint16_t i = 0; i < entryCount; i++)
+    {
+        if (pos + 46 > data.size() || readUint32(data, pos) != 0x02014b50)
+        {
+            throw std::runtime_error("invalid ZIP archive: broken central directory");
+        }
+        Entry entry;
+        const uint16_t flags = readUint16(data, pos + 8);
+        entry.method = readUint16(data, pos + 10);
+        entry.compressedSize = readUint32(data, pos + 20);
+        const uint16_t nameSize = readUint16(data, pos + 28);
+        const uint16_t extraSize = readUint16(data, pos + 30);
+        const uint16_t commentSize = readUint16(data, pos + 32);
+        entry.localHeaderOffset = readUint32(data, pos + 42);
+        if (pos + 46 + nameSize > data.size())
+        {
+            throw std::runtime_error("invalid ZIP archive: broken central directory");
+        }
+        entry.name.assign(data.data() + pos + 46, nameSize);
+        if ((flags & 1) != 0)
+        {
+            throw std::runtime_error("encrypted ZIP entries are not supported: " + entry.name);
+        }
+        entries.push_back(std::move(entry));
+        pos += 46 + nameSize + extraSize + commentSize;
+    }
+}
+
+const ZipArchive::Entry &ZipArchive::find(const std::string &name) const
+{
+    for (auto &&entry : entries)
+    {
+        if (entry.name == name)
+        {
+            return entry;
+        }
+    }
+    throw std::runtime_error("ZIP entry not found: " + name);
+}
+
+bool ZipArchive::contains(const std::string &name) const
+{
+    return std::any_of(entries.begin(), entries.end(), [&](const Entry &entry)
+    {
+        return entry.name == name;
+    });
+}
+
+Inflater ZipArchive::open(const std::string &name) const
+{
+    const Entry &entry = find(name);
+    const size_t pos = entry.localHeaderOffset;
+    if (pos + 30 > data.size() || readUint32(data, pos) != 0x04034b50)
+    {
+        throw std::runtime_error("invalid ZIP archive: broken entry " + name);
+    }
+    // The local header may have another extra field than the central directory.
+    const size_t dataPos = pos + 30 + readUint16(data, pos + 26) + readUint16(data, pos + 28);
+    if (dataPos + entry.compressedSize > data.size())
+    {
+        throw std::runtime_error("invalid ZIP archive: truncated entry " + name);
+    }
+    const std::string_view compressed = data.substr(dataPos, entry.compressedSize);
+
+    if (entry.method != 0 && entry.method != 8)
+    {
+            throw std::runtime_error("unsupported ZIP compression method for " + name);
+    }
+    return Inflater(compressed, entry.method == 0);
+}
+
+std::string ZipArchive::read(const std::string &name) const
+{
+    Inflater inflater = open(name);
+    std::string content;
+    for (std::string_view piece = inflater.next(); !piece.empty(); piece = inflater.next())
+    {
+        content.append(piece);
+    }
+    return content;
+}
@@ -0,0 +1,120 @@
+#ifndef ZIP_READER_HPP
+#define ZIP_READER_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Streaming decoder of raw DEFLATE data (RFC 1951), handing out the inflated data piece by
+ * piece so that large entries are never held whole.
+ */
+class Inflater
+{
+public:
+    /**
+     * Reader of compressed data, or of data stored as is when isStored.
+     */
+    explicit Inflater(std::string_view compressed, bool isStored = false);
+
+    /**
+     * Next piece of the inflated data, empty at the end. The piece stays valid until the next
+     * call.
+     *
+     * Throws std::runtime_error on corrupt or truncated data.
+     */
+    std::string_view next();
+
+private:
+    /**
+     * Canonical Huffman code, decoded through a table of the codes up to fastBits long.
+     */
+    struct HuffmanTable
+    {
+        static const int fastBits = 10;
+        // symbol << 4 | code length, 0 for the codes longer than fastBits.
+        std::array<uint16_t, 1 << fastBits> fastEntries;
+        std::array<uint16_t, 16> lengthCounts;
+        // Symbols ordered by code length, then by value.
+        std::array<uint16_t, 320> symbols;
+    };
+
+    static void buildTable(const uint8_t *lengths, size_t count, HuffmanTable &table);
+    void refill();
+    uint32_t peekBits(int count);
+    void skipBits(int count);
+    uint32_t readBits(int count);
+    int decodeSymbol(const HuffmanTable &table);
+    void readBlockHeader();
+    void readDynamicTables();
+    /**
+     * Inflate up to the end of the window, stopping at a symbol boundary.
+     */
+    void inflateBlocks();
+
+    std::string_view compressed;
+    bool isStored;
+    size_t inputPos = 0;
+    uint64_t bitBuffer = 0;
+    int bitCount = 0;
+    uint64_t consumedBitCount = 0;
+
+    // The last 32 KB inflated, which matches may refer to, then the piece being inflated.
+    std::vector<char> window;
+    size_t windowPos = 0;
+
+    bool isFinalBlock = false;
+    bool isDone = false;
+    // -1 between blocks, otherwise the BTYPE of the current block.
+    int blockType = -1;
+    size_t storedSize = 0;
+    HuffmanTable literalTable;
+    HuffmanTable distanceTable;
+};
+
+/**
+ * Entries of a ZIP archive held in memory, e.g. an .xlsx or .ods file. Stored and deflated
+ * entries are supported, ZIP64 and encryption are not.
+ */
+class ZipArchive
+{
+public:
+    /**
+     * Read the central directory of the archive. The data must outlive the archive.
+     *
+     * Throws std::runtime_error when the data is not a ZIP archive.
+     */
+    explicit ZipArchive(std::string_view data);
+
+    bool contains(const std::string &name) const;
+
+    /**
+     * Streaming reader of an entry.
+     *
+     * Throws std::runtime_error when the entry is missing or uses an unsupported method.
+     */
+    Inflater open(const std::string &name) const;
+
+    /**
+     * Whole content of an entry, for the small ones.
+     */
+    std::string read(const std::string &name) const;
+
+private:
+    struct Entry
+    {
+        std::string name;
+        uint16_t method = 0;
+        uint32_t compressedSize = 0;
+        uint32_t localHeaderOffset = 0;
+    };
+
+    const Entry &find(const std::string &name) const;
+
+    std::string_view data;
+    std::vector<Entry> entries;
+};
+
+#endif // ZIP_READER_HPP
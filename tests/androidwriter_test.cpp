@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../src/convert.hpp"
+#include "check.hpp"
+
+/**
+ * Write the keys through the "android" writer and list the resource names, in file order.
+ */
+static std::vector<std::string> writeNames(const std::vector<std::string> &keys)
+{
+    std::vector<LocaleEntry> entries;
+    for (auto &&key : keys)
+    {
+        entries.push_back({key, "text"});
+    }
+    const std::string file = makeLocaleWriter("android")->write(entries, "en", true);
+    std::vector<std::string> names;
+    const std::string nameStart = "<string name=\"";
+    for (size_t pos = file.find(nameStart); pos != std::string::npos; pos = file.find(nameStart, pos))
+    {
+        pos += nameStart.size();
+        names.push_back(file.substr(pos, file.find('"', pos) - pos));
+    }
+    return names;
+}
+
+/**
+ * Name of the generated R field, which aapt gives '_' in place of '.'.
+ */
+static std::string aaptName(std::string name)
+{
+    std::replace(name.begin(), name.end(), '.', '_');
+    return name;
+}
+
+int main()
+{
+    check(writeNames({"menu.open", "1st", "tab\tkey", ""}) == std::vector<std::string>({"menu.open", "_1st", "tab_key", "_"}), "plain names");
+
+    // Keys of the same name: the key written as is keeps it, then the others in byte order.
+    const std::vector<std::string> names = writeNames({"menu-open", "menu open", "menu_open", "menu.open", "menu_open_2"});
+    check(names == std::vector<std::string>({"menu_open_4", "menu_open_3", "menu_open", "menu.open_5", "menu_open_2"}), "colliding names");
+    std::vector<std::string> fieldNames;
+    for (auto &&name : names)
+    {
+        fieldNames.push_back(aaptName(name));
+    }
+    std::sort(fieldNames.begin(), fieldNames.end());
+    check(std::adjacent_find(fieldNames.begin(), fieldNames.end()) == fieldNames.end(), "unique field names");
+
+    // The names do not depend on the order of the rows.
+    check(writeNames({"menu_open_2", "menu.open", "menu_open", "menu open", "menu-open"})
+              == std::vector<std::string>({"menu_open_2", "menu.open_5", "menu_open", "menu_open_3", "menu_open_4"}),
+          "names in another row order");
+
+    return checkResult();
+}
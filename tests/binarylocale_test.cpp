@@ -0,0 +1,93 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../src/binarylocale.hpp"
+#include "../src/convert.hpp"
+#include "check.hpp"
+
+/**
+ * Write the entries through the "bin" writer and check that every key is found with its text,
+ * and that the other keys are not.
+ */
+static void checkRoundTrip(const std::string &name, const std::vector<LocaleEntry> &entries, const std::vector<std::string> &missingKeys)
+{
+    const std::string file = makeLocaleWriter("bin")->write(entries, "en", false);
+    const BinaryLocale locale(file.data(), file.size());
+    check(locale.size() == entries.size(), name + ": entry count");
+    for (auto &&entry : entries)
+    {
+        const std::optional<std::string_view> text = locale.find(entry.key);
+        check(text == std::optional<std::string_view>(entry.text), name + ": text of " + std::string(entry.key));
+    }
+    for (auto &&key : missingKeys)
+    {
+        check(!locale.find(key), name + ": unexpected key " + key);
+    }
+}
+
+int main()
+{
+    checkRoundTrip("empty locale", {}, {"", "menu.open"});
+    checkRoundTrip("one entry", {{"menu.open", "Open"}}, {"", "menu.close", "menu.ope"});
+
+    // Keys of the same bucket: the writer uses count / 2 buckets, so 64 keys give 32.
+    const size_t keyCount = 64;
+    const uint32_t bucketCount = keyCount / 2;
+    const uint64_t bucket = binaryLocaleHash("menu.open") % bucketCount;
+    std::vector<std::string> keys = {"menu.open"};
+    for (int i = 0; keys.size() < 8; i++)
+    {
+        const std::string key = "colliding." + std::to_string(i);
+        if (binaryLocaleHash(key) % bucketCount == bucket)
+        {
+            keys.push_back(key);
+        }
+    }
+    for (int i = 0; keys.size() < keyCount; i++)
+    {
+        keys.push_back("other." + std::to_string(i));
+    }
+    std::vector<std::string> texts;
+    for (auto &&key : keys)
+    {
+        texts.push_back("text of " + key + " 文字");
+    }
+    std::vector<LocaleEntry> entries;
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        entries.push_back({keys[i], texts[i]});
+    }
+    checkRoundTrip("colliding buckets", entries, {"menu.close", "colliding.x", "other." + std::to_string(keyCount)});
+
+    // Many keys, including an empty one and an empty text.
+    std::vector<std::string> manyKeys = {""};
+    for (int i = 0; i < 10000; i++)
+    {
+        manyKeys.push_back("key." + std::to_string(i));
+    }
+    std::vector<LocaleEntry> manyEntries;
+    for (auto &&key : manyKeys)
+    {
+        manyEntries.push_back({key, key == "key.1" ? "" : std::string_view(key)});
+    }
+    checkRoundTrip("10000 keys", manyEntries, {"key.10000", "key.-1", "KEY.1"});
+
+    // Literal \n sequences are dropped when asked to, like in the other formats.
+    const std::vector<LocaleEntry> breakEntries = {{"multiline", "one\\ntwo\nthree"}};
+    const std::string file = makeLocaleWriter("bin")->write(breakEntries, "en", true);
+    check(BinaryLocale(file.data(), file.size()).find("multiline") == std::optional<std::string_view>("onetwo\nthree"), "replaced line break");
+
+    bool isRejected = false;
+    try
+    {
+        BinaryLocale(file.data(), BinaryLocale::headerSize - 1);
+    }
+    catch (const std::runtime_error &)
+    {
+        isRejected = true;
+    }
+    check(isRejected, "truncated header");
+
+    return checkResult();
+}
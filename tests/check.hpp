@@ -0,0 +1,37 @@
+#ifndef CHECK_HPP
+#define CHECK_HPP
+
+#include <cstdio>
+#include <string>
+
+// Helpers shared by the test programs, each a main() run by CTest.
+
+inline int failureCount = 0;
+
+/**
+ * Report a failed check, without stopping the test.
+ */
+inline void check(bool condition, const std::string &message)
+{
+    if (!condition)
+    {
+        std::fprintf(stderr, "FAILED: %s\n", message.c_str());
+        failureCount++;
+    }
+}
+
+/**
+ * Exit status of the test program, after a summary of the checks.
+ */
+inline int checkResult()
+{
+    if (failureCount > 0)
+    {
+        std::fprintf(stderr, "%d checks failed\n", failureCount);
+        return 1;
+    }
+    std::printf("all checks passed\n");
+    return 0;
+}
+
+#endif // CHECK_HPP
@@ -0,0 +1,107 @@
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "rapidcsv.h"
+#include "../src/convert.hpp"
+#include "check.hpp"
+
+static void writeFile(const std::filesystem::path &path, const std::string &content)
+{
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+}
+
+/**
+ * Import the locale files into a copy of the sheet, returning the result or nothing when the
+ * import failed.
+ */
+static std::optional<ImportResult> importInto(const ImportOptions &options)
+{
+    try
+    {
+        return importTranslations(options);
+    }
+    catch (const std::exception &error)
+    {
+        check(false, "import failed: " + std::string(error.what()));
+        return std::nullopt;
+    }
+}
+
+int main()
+{
+    const std::filesystem::path workFolder = std::filesystem::temp_directory_path() / "qpp-lang-converter-import-test";
+    std::filesystem::remove_all(workFolder);
+    std::filesystem::create_directories(workFolder);
+
+    const std::string sheetFilename = (workFolder / "sheet.csv").u8string();
+    writeFile(sheetFilename, "key,en,zh\n"
+                             "menu.open,Open,打开\n"
+                             "menu.close,Close,\n"
+                             "menu.help,Help\\nme,\"帮助\n我\"\n");
+
+    ConvertOptions options;
+    options.translationFilename = sheetFilename;
+    options.outputBaseFolder = (workFolder / "locales").u8string();
+    options.columnNameIndex = 0;
+    options.rowNameIndex = 0;
+    options.missingTranslation = MissingTranslation::Fallback;
+    options.fallbackLangNames = {"en"};
+    options.pseudoLangName = "en-XA";
+    options.serial = "test";
+    options.reportFilename.clear();
+    convertTranslations(options);
+    const std::string enFilename = (workFolder / "locales" / "en" / "common-test.json").u8string();
+    const std::string zhFilename = (workFolder / "locales" / "zh" / "common-test.json").u8string();
+
+    ImportOptions importOptions;
+    importOptions.translationFilename = sheetFilename;
+    importOptions.outputFilename = (workFolder / "imported.csv").u8string();
+    importOptions.columnNameIndex = 0;
+    importOptions.rowNameIndex = 0;
+    importOptions.missingTranslation = options.missingTranslation;
+    importOptions.fallbackLangNames = options.fallbackLangNames;
+    importOptions.pseudoLangName = options.pseudoLangName;
+
+    // The files just converted change no cell, not even the empty one given the en text.
+    importOptions.localeFilenames = {{"en", enFilename}, {"zh", zhFilename}};
+    std::optional<ImportResult> result = importInto(importOptions);
+    check(result && result->updatedCellCounts["en"] == 0, "unchanged en cells");
+    check(result && result->updatedCellCounts["zh"] == 0, "unchanged zh cells");
+    rapidcsv::Document imported = readCvs(importOptions.outputFilename, 0, 0);
+    check(imported.GetCell<std::string>("zh", "menu.close").empty(), "fallback text not imported");
+    check(imported.GetCell<std::string>("en", "menu.help") == "Help\\nme", "cell with a dropped \\n kept");
+
+    // A correction of the empty cell is imported.
+    writeFile(workFolder / "zh.json", "{\"menu.open\": \"打开\", \"menu.close\": \"关闭\", \"menu.help\": \"帮助\\n我\"}");
+    importOptions.localeFilenames = {{"zh", (workFolder / "zh.json").u8string()}};
+    result = importInto(importOptions);
+    check(result && result->updatedCellCounts["zh"] == 1, "corrected zh cell");
+    imported = readCvs(importOptions.outputFilename, 0, 0);
+    check(imported.GetCell<std::string>("zh", "menu.close") == "关闭", "corrected text imported");
+    check(imported.GetCell<std::string>("zh", "menu.help") == "帮助\n我", "multi-line cell kept");
+
+    // Converted without a fallback, the en text is a correction of the empty cell.
+    importOptions.missingTranslation = MissingTranslation::Keep;
+    importOptions.localeFilenames = {{"zh", zhFilename}};
+    result = importInto(importOptions);
+    check(result && result->updatedCellCounts["zh"] == 1, "fallback text imported without --missing fallback");
+
+    bool isRejected = false;
+    importOptions.localeFilenames = {{"en-XA", (workFolder / "locales" / "en-XA" / "common-test.json").u8string()}};
+    try
+    {
+        importTranslations(importOptions);
+    }
+    catch (const std::invalid_argument &)
+    {
+        isRejected = true;
+    }
+    check(isRejected, "pseudo-locale import");
+
+    std::filesystem::remove_all(workFolder);
+    return checkResult();
+}
@@ -0,0 +1,71 @@
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../src/convert.hpp"
+#include "../src/json.hpp"
+#include "check.hpp"
+
+/**
+ * Write the entries through the "json" writer and parse the file back.
+ */
+static std::map<std::string, std::string> writeAndParse(const std::vector<LocaleEntry> &entries, bool shouldReplaceBreakLines)
+{
+    const std::string file = makeLocaleWriter("json")->write(entries, "en", shouldReplaceBreakLines);
+    std::map<std::string, std::string> parsed;
+    try
+    {
+        parseJsonObject(file, [&](std::string &&key, std::string &&value)
+        {
+            parsed.emplace(std::move(key), std::move(value));
+        });
+    }
+    catch (const std::runtime_error &error)
+    {
+        check(false, "invalid JSON (" + std::string(error.what()) + "): " + file);
+    }
+    return parsed;
+}
+
+/**
+ * Check that a cell is read back as the expected text, with and without replacing the literal
+ * \n sequences.
+ */
+static void checkCell(const std::string &cell, const std::string &expected, const std::string &expectedReplaced)
+{
+    for (bool shouldReplaceBreakLines : {false, true})
+    {
+        const std::map<std::string, std::string> parsed = writeAndParse({{"key", cell}}, shouldReplaceBreakLines);
+        const auto it = parsed.find("key");
+        check(it != parsed.end() && it->second == (shouldReplaceBreakLines ? expectedReplaced : expected),
+              "cell " + quoteJson(cell) + (shouldReplaceBreakLines ? " with" : " without") + " break line replacement");
+    }
+}
+
+int main()
+{
+    checkCell("plain text 文字", "plain text 文字", "plain text 文字");
+    checkCell("say \"hi\"", "say \"hi\"", "say \"hi\"");
+    // A cell ending in an escaped backslash before a quote.
+    checkCell("end\\\\\"", "end\\\\\"", "end\\\\\"");
+    checkCell("C:\\temp", "C:\\temp", "C:\\temp");
+    checkCell("trailing \\", "trailing \\", "trailing \\");
+    checkCell("\\\"quoted\\\"", "\\\"quoted\\\"", "\\\"quoted\\\"");
+    checkCell("line\nbreak\r\ttab", "line\nbreak\r\ttab", "line\nbreak\r\ttab");
+    checkCell(std::string("controls \x01\x08\x0c\x1f and NUL ") + '\0', std::string("controls \x01\x08\x0c\x1f and NUL ") + '\0',
+              std::string("controls \x01\x08\x0c\x1f and NUL ") + '\0');
+    // Literal \n sequences are JSON line breaks, or dropped when replacing them.
+    checkCell("one\\ntwo", "one\ntwo", "onetwo");
+    checkCell("\\\\n", "\\\n", "\\");
+
+    const std::map<std::string, std::string> parsed = writeAndParse({{"say \"hi\"", "1"}, {"C:\\temp\\n", "2"}, {"tab\tkey", "3"}}, true);
+    check(parsed.size() == 3, "escaped keys");
+    check(parsed.count("say \"hi\"") == 1, "key with quotes");
+    check(parsed.count("C:\\temp\\n") == 1, "key with backslashes");
+    check(parsed.count("tab\tkey") == 1, "key with a tab");
+
+    check(writeAndParse({}, false).empty(), "empty locale");
+
+    return checkResult();
+}
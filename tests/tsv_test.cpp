@@ -0,0 +1,66 @@
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "rapidcsv.h"
+#include "../src/convert.hpp"
+#include "check.hpp"
+
+/**
+ * Write a TSV file and read it back, keys in column 0 and column names in row 0. Returns
+ * nothing when it cannot be read.
+ */
+static std::optional<rapidcsv::Document> readTsv(const std::filesystem::path &path, const std::string &content,
+                                                 const std::optional<CsvDialect> &dialect = std::nullopt)
+{
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << content;
+    }
+    try
+    {
+        return readCvs(path.u8string(), 0, 0, dialect);
+    }
+    catch (const std::exception &error)
+    {
+        check(false, "cannot read " + path.u8string() + ": " + error.what());
+        return std::nullopt;
+    }
+}
+
+int main()
+{
+    const std::filesystem::path workFolder = std::filesystem::temp_directory_path() / "qpp-lang-converter-tsv-test";
+    std::filesystem::remove_all(workFolder);
+    std::filesystem::create_directories(workFolder);
+    const std::filesystem::path path = workFolder / "sheet.tsv";
+
+    // Quoted cells holding a line break, a tab and quotes, and unquoted commas.
+    std::optional<rapidcsv::Document> doc = readTsv(path, "key\ten\tzh\r\n"
+                                                          "menu.open\tOpen, now\t打开\r\n"
+                                                          "menu.help\t\"Help\r\nme\"\t\"帮助\t我\"\r\n"
+                                                          "menu.say\t\"Say \"\"hi\"\"\"\t说\r\n");
+    check(doc && doc->GetRowCount() == 3, "row count");
+    check(doc && doc->GetColumnCount() == 2, "column count");
+    check(doc && doc->GetCell<std::string>("en", "menu.open") == "Open, now", "unquoted cell with a comma");
+    check(doc && doc->GetCell<std::string>("en", "menu.help") == "Help\r\nme", "quoted multi-line cell");
+    check(doc && doc->GetCell<std::string>("zh", "menu.help") == "帮助\t我", "quoted cell with a tab");
+    check(doc && doc->GetCell<std::string>("en", "menu.say") == "Say \"hi\"", "quoted cell with quotes");
+    check(doc && doc->GetCell<std::string>("zh", "menu.say") == "说", "cell after a multi-line row");
+
+    // A given dialect is used instead of the TSV one.
+    CsvDialect dialect;
+    dialect.separator = '\t';
+    dialect.quoteChar = '\'';
+    doc = readTsv(path, "key\ten\n"
+                        "menu.help\t'Help\nme'\n"
+                        "menu.say\t\"hi\"\n",
+                  dialect);
+    check(doc && doc->GetCell<std::string>("en", "menu.help") == "Help\nme", "multi-line cell quoted with '");
+    check(doc && doc->GetCell<std::string>("en", "menu.say") == "\"hi\"", "double quotes kept with '");
+
+    std::filesystem::remove_all(workFolder);
+    return checkResult();
+}